@@ -0,0 +1,277 @@
+
+/*
+    Copyright Kristjan Kongas 2020
+
+    Boost Software License - Version 1.0 - August 17th, 2003
+
+    Permission is hereby granted, free of charge, to any person or organization
+    obtaining a copy of the software and accompanying documentation covered by
+    this license (the "Software") to use, reproduce, display, distribute,
+    execute, and transmit the Software, and to prepare derivative works of the
+    Software, and to permit third-parties to whom the Software is furnished to
+    do so, all subject to the following:
+
+    The copyright notices in the Software and this entire statement, including
+    the above license grant, this restriction and the following disclaimer,
+    must be included in all copies of the Software, in whole or in part, and
+    all derivative works of the Software, unless such copies or derivative
+    works are solely in the form of machine-executable object code generated by
+    a source language processor.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+// Microbenchmarks of parser internals. Prints one JSON object per line to stdout:
+//     {"benchmark": "...", "library": "...", "size": N, "iterations": K, "min_ns": ..., "median_ns": ..., "mean_ns": ...}
+// Usage: fire_bench [name_filter]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../fire.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define FIRE_BENCH_GETOPT
+#include <getopt.h>
+#endif
+
+using namespace std;
+
+namespace {
+    const double min_total_seconds = 0.2;
+    const int min_iterations = 3;
+    const int max_iterations = 100000;
+    volatile size_t sink = 0;
+    const char *filter = nullptr;
+
+    class argv_holder { // Owns tokens and a null-terminated argv pointing into them
+        vector<string> _tokens;
+        vector<const char *> _argv;
+
+    public:
+        explicit argv_holder(vector<string> tokens): _tokens(std::move(tokens)) {
+            _tokens.insert(_tokens.begin(), "./bench");
+            for(const string &token: _tokens)
+                _argv.push_back(token.c_str());
+            _argv.push_back(nullptr);
+        }
+
+        int argc() const { return (int) _tokens.size(); }
+        const char **argv() { return _argv.data(); }
+    };
+
+    void reset(argv_holder &args) {
+        fire::_::help_logger() = fire::_help_logger();
+        fire::_::matcher() = fire::_matcher(args.argc(), args.argv(), 1000000, false, false);
+    }
+
+    void run(const string &benchmark, const string &library, size_t size,
+             const function<void()> &setup, const function<void()> &body) {
+        if(filter && benchmark.find(filter) == string::npos)
+            return;
+
+        using clock = chrono::steady_clock;
+        vector<double> samples;
+        double total = 0;
+        while(samples.size() < (size_t) max_iterations &&
+              (samples.size() < (size_t) min_iterations || total < min_total_seconds * 1e9)) {
+            setup();
+            clock::time_point start = clock::now();
+            body();
+            double ns = (double) chrono::duration_cast<chrono::nanoseconds>(clock::now() - start).count();
+            samples.push_back(ns);
+            total += ns;
+        }
+
+        sort(samples.begin(), samples.end());
+        cout << "{\"benchmark\": \"" << benchmark << "\", \"library\": \"" << library << "\", \"size\": " << size
+             << ", \"iterations\": " << samples.size() << fixed
+             << ", \"min_ns\": " << (long long) samples.front()
+             << ", \"median_ns\": " << (long long) samples[samples.size() / 2]
+             << ", \"mean_ns\": " << (long long) (total / samples.size()) << "}" << endl;
+        cout.unsetf(ios::fixed);
+    }
+
+    void nothing() {}
+
+    void consume(size_t value) { // Keeps results from being optimized away
+        sink = sink + value;
+    }
+
+    void bench_parse(size_t size) { // Named and positional tokens, half each
+        vector<string> tokens;
+        for(size_t i = 0; i < size; ++i)
+            tokens.push_back(i % 2 ? to_string(i) : "--name" + to_string(i) + "=" + to_string(i));
+        argv_holder args(tokens);
+
+        run("matcher_parse", "fire", size, nothing, [&] {
+            fire::_matcher matcher(args.argc(), args.argv(), 1000000, false, false);
+            consume(matcher.get_positional().size());
+        });
+    }
+
+    void bench_query(size_t size) { // Every named argument declared and queried once
+        vector<string> tokens;
+        vector<fire::identifier> ids;
+        for(size_t i = 0; i < size; ++i) {
+            tokens.push_back("--param" + to_string(i) + "=" + to_string(i));
+            ids.push_back(fire::identifier({"--param" + to_string(i)}, fire::optional<int>()));
+        }
+        argv_holder args(tokens);
+
+        run("get_and_mark_as_queried", "fire", size, [&] { reset(args); }, [&] {
+            for(const fire::identifier &id: ids)
+                consume(fire::_::matcher().get_and_mark_as_queried(id).first.size());
+        });
+    }
+
+    template <typename T>
+    void bench_vector(const string &type, size_t size, const function<string(size_t)> &make_token, unsigned threads = 1) {
+        vector<string> tokens;
+        for(size_t i = 0; i < size; ++i)
+            tokens.push_back(make_token(i));
+        argv_holder args(tokens);
+
+        string library = threads == 1 ? "fire" : "fire_parallel";
+        run("vector_conversion_" + type, library, size, [&] { reset(args); }, [&] {
+            vector<T> values;
+            if(threads == 1)
+                values = fire::arg::vector();
+            else
+                values = fire::arg::vector().parallel(threads);
+            consume(values.size());
+        });
+    }
+
+    void bench_help(size_t size) {
+        argv_holder args({});
+        reset(args);
+        fire::_help_logger logger;
+        for(size_t i = 0; i < size; ++i) {
+            fire::identifier id({"--option" + to_string(i)}, fire::optional<int>());
+            logger.log(id, {"Description of option " + to_string(i), "INTEGER", to_string(i), false});
+        }
+
+        ostringstream discard;
+        streambuf *cerr_buffer = cerr.rdbuf(discard.rdbuf());
+        run("print_help", "fire", size, [&] { discard.str(""); }, [&] { logger.print_help(); });
+        cerr.rdbuf(cerr_buffer);
+    }
+
+    const int end_to_end_options = 8;
+
+    vector<string> end_to_end_tokens(size_t size) { // A few named options followed by integer positionals
+        vector<string> tokens;
+        for(int i = 0; i < end_to_end_options; ++i)
+            tokens.push_back("--opt" + to_string(i) + "=" + to_string(i * 10));
+        for(size_t i = 0; i < size; ++i)
+            tokens.push_back(to_string(i));
+        return tokens;
+    }
+
+    void bench_end_to_end_fire(size_t size) {
+        argv_holder args(end_to_end_tokens(size));
+        vector<string> names;
+        for(int i = 0; i < end_to_end_options; ++i)
+            names.push_back("--opt" + to_string(i));
+
+        run("end_to_end", "fire", size, [] { fire::_::help_logger() = fire::_help_logger(); }, [&] {
+            fire::_::matcher() = fire::_matcher(args.argc(), args.argv(), 1000000, false, false);
+            for(const string &name: names)
+                consume((int) fire::arg(name.c_str()));
+            vector<int> values = fire::arg::vector();
+            consume(values.size());
+        });
+    }
+
+#ifdef FIRE_BENCH_GETOPT
+    void bench_end_to_end_getopt(size_t size) {
+        argv_holder args(end_to_end_tokens(size));
+        vector<string> names;
+        vector<option> options;
+        for(int i = 0; i < end_to_end_options; ++i)
+            names.push_back("opt" + to_string(i));
+        for(int i = 0; i < end_to_end_options; ++i)
+            options.push_back({names[i].c_str(), required_argument, nullptr, i});
+        options.push_back({nullptr, 0, nullptr, 0});
+
+        auto to_int = [](const char *s, int &out) {
+            char *end;
+            errno = 0;
+            long value = strtol(s, &end, 10);
+            out = (int) value;
+            return *s && ! *end && errno == 0 && value >= INT32_MIN && value <= INT32_MAX;
+        };
+
+        vector<char *> argv;
+        run("end_to_end", "getopt_long", size, [&] {
+            argv.clear(); // getopt_long may permute argv
+            for(int i = 0; i <= args.argc(); ++i)
+                argv.push_back(const_cast<char *>(args.argv()[i]));
+        }, [&] {
+#ifdef __GLIBC__
+            optind = 0;
+#else
+            optreset = 1;
+            optind = 1;
+#endif
+            int option_values[end_to_end_options];
+            int c;
+            while((c = getopt_long(args.argc(), argv.data(), "", options.data(), nullptr)) != -1)
+                if(c >= 0 && c < end_to_end_options && ! to_int(optarg, option_values[c]))
+                    abort();
+            for(int i = 0; i < end_to_end_options; ++i)
+                consume(option_values[i]);
+
+            vector<int> values(args.argc() - optind);
+            for(int i = optind; i < args.argc(); ++i)
+                if(! to_int(argv[i], values[i - optind]))
+                    abort();
+            consume(values.size());
+        });
+    }
+#endif
+}
+
+int main(int argc, const char **argv) {
+    if(argc > 1)
+        filter = argv[1];
+
+    for(size_t size: {10, 1000, 100000, 1000000})
+        bench_parse(size);
+
+    for(size_t size: {10, 1000, 10000})
+        bench_query(size);
+
+    for(size_t size: {1000, 1000000}) {
+        bench_vector<int>("int", size, [](size_t i) { return to_string((int) i - 500); });
+        bench_vector<double>("double", size, [](size_t i) { return to_string(i) + ".25e-3"; });
+        bench_vector<string>("string", size, [](size_t i) { return "token" + to_string(i); });
+        bench_vector<int>("int", size, [](size_t i) { return to_string((int) i - 500); }, 0);
+        bench_vector<double>("double", size, [](size_t i) { return to_string(i) + ".25e-3"; }, 0);
+    }
+
+    for(size_t size: {100, 1000, 5000})
+        bench_help(size);
+
+    for(size_t size: {10, 1000, 100000, 1000000}) {
+        bench_end_to_end_fire(size);
+#ifdef FIRE_BENCH_GETOPT
+        bench_end_to_end_getopt(size);
+#endif
+    }
+
+    return 0;
+}
@@ -34,6 +34,7 @@
 
 #include <string>
 #include <iostream>
+#include <fstream>
 #include <vector>
 #include <map>
 #include <unordered_map>
@@ -44,17 +45,68 @@
 #include <algorithm>
 #include <type_traits>
 #include <limits>
+#include <cstdint>
+#include <tuple>
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <memory>
+#include <stdexcept>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define FIRE_POSIX_
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(FIRE_POSIX_)
+extern char **environ; // Not declared by <unistd.h> on Mac OS
+#endif
+
+#if ! defined(FIRE_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define FIRE_SIMD_X86_ // Vectorized number conversion, selected at runtime by CPU support
+#include <immintrin.h>
+#endif
 
+#ifdef FIRE_TRACE
+#include <atomic>
+#include <chrono>
+#include <new>
+#ifdef FIRE_POSIX_
+#include <sys/resource.h>
+#endif
+#endif
 
 namespace fire {
     constexpr int _failure_code = 1;
 
+    class error: public std::runtime_error { // Thrown instead of exiting by parsers in on_error::throw_exception mode
+        int _code;
+
+    public:
+        error(const std::string &output, int code): std::runtime_error(output), _code(code) {}
+        int code() const { return _code; } // Exit code the process would have had, 0 for help
+    };
+
+    enum class on_error { exit, throw_exception };
+
+    inline void _exit_or_throw(int code, const std::string &output); // output is the text printed to stderr on exit
+
     template<typename R, typename ... Types>
     constexpr size_t _get_argument_count(R(*)(Types ...)) { return sizeof...(Types); }
 
-    inline void _instant_assert(bool pass, const std::string &msg, bool programmer_side = true);
-    inline int count_hyphens(const std::string &s);
-    inline std::string without_hyphens(const std::string &s);
+    inline void _instant_assert(bool pass, const char *msg, bool programmer_side = true); // String is built on failure
+    template <typename F, typename = decltype(std::string(std::declval<const F &>()()))>
+    inline void _instant_assert(bool pass, const F &build_msg, bool programmer_side = true); // Builds message on failure
 
     template <typename T>
     class optional {
@@ -70,22 +122,467 @@ namespace fire {
         bool has_value() const { return _exists; }
         T value_or(const T& def) const { return _exists ? _value : def; }
         T value() const { _instant_assert(_exists, "accessing unassigned optional"); return _value; }
+        const T& operator*() const { return _value; }
+    };
+
+    class string_view { // C++11 compatible subset of std::string_view
+        const char *_data = "";
+        size_t _size = 0;
+
+    public:
+        enum : size_t { npos = (size_t) -1 };
+
+        string_view() = default;
+        string_view(const char *data): _data(data), _size(std::char_traits<char>::length(data)) {}
+        string_view(const char *data, size_t size): _data(data), _size(size) {}
+        template <typename S, typename std::enable_if<std::is_same<S, std::string>::value>::type* = nullptr>
+        string_view(const S &s): _data(s.c_str()), _size(s.size()) {} // Template prevents ambiguous conversions from fire::arg
+
+        const char * data() const { return _data; }
+        const char * c_str() const { return _data; } // Views obtained from fire::arg are always null-terminated
+        size_t size() const { return _size; }
+        bool empty() const { return _size == 0; }
+        const char * begin() const { return _data; }
+        const char * end() const { return _data + _size; }
+        char operator[](size_t i) const { return _data[i]; }
+        char front() const { return _data[0]; }
+        char back() const { return _data[_size - 1]; }
+
+        string_view substr(size_t pos, size_t n = npos) const { return {_data + pos, std::min(n, _size - pos)}; }
+        size_t find(char c, size_t pos = 0) const {
+            for(size_t i = pos; i < _size; ++i)
+                if(_data[i] == c) return i;
+            return npos;
+        }
+        int compare(const string_view &other) const {
+            int cmp = std::char_traits<char>::compare(_data, other._data, std::min(_size, other._size));
+            return cmp != 0 ? cmp : (_size < other._size ? -1 : _size > other._size);
+        }
+
+        std::string str() const { return std::string(_data, _size); }
+        operator std::string() const { return str(); }
+
+        friend bool operator==(const string_view &a, const string_view &b) {
+            return a._size == b._size && std::char_traits<char>::compare(a._data, b._data, a._size) == 0;
+        }
+        friend bool operator!=(const string_view &a, const string_view &b) { return ! (a == b); }
+        friend bool operator<(const string_view &a, const string_view &b) { return a.compare(b) < 0; }
+        friend std::string operator+(const std::string &a, const string_view &b) { return a + b.str(); }
+        friend std::string operator+(const string_view &a, const std::string &b) { return a.str() + b; }
+        friend std::ostream& operator<<(std::ostream &os, const string_view &s) { return os.write(s._data, s._size); }
+    };
+
+    struct _string_view_hash { // FNV-1a
+        size_t operator()(const string_view &s) const {
+            uint64_t hash = 14695981039346656037ULL;
+            for(char c: s) {
+                hash ^= (unsigned char) c;
+                hash *= 1099511628211ULL;
+            }
+            return (size_t) hash;
+        }
+    };
+
+    // Perfect hash table of option names, built at compile time by FIRE_NAMES(...)
+    constexpr uint32_t _name_hash(const char *s, uint32_t hash = 2166136261u) { // FNV-1a
+        return *s ? _name_hash(s + 1, (hash ^ (unsigned char) *s) * 16777619u) : hash;
+    }
+
+    inline uint32_t _name_hash(const string_view &s) {
+        uint32_t hash = 2166136261u;
+        for(char c: s)
+            hash = (hash ^ (unsigned char) c) * 16777619u;
+        return hash;
+    }
+
+    constexpr uint32_t _name_avalanche(uint32_t x) { return x ^ (x >> 13); }
+    constexpr uint32_t _name_bucket(uint32_t hash, uint32_t seed, size_t mask) {
+        return _name_avalanche((hash ^ (seed * 0x9e3779b9u)) * 0x85ebca6bu) & (uint32_t) mask;
+    }
+
+    constexpr size_t _name_table_size(size_t n, size_t size = 8) { // Power of two >= n
+        return size >= n ? size : _name_table_size(n, 2 * size);
+    }
+
+    template <size_t... I> struct _indices {};
+    template <typename A, typename B> struct _concat_indices;
+    template <size_t... A, size_t... B>
+    struct _concat_indices<_indices<A...>, _indices<B...>> { using type = _indices<A..., (sizeof...(A) + B)...>; };
+    template <size_t N>
+    struct _make_indices {
+        using type = typename _concat_indices<typename _make_indices<N / 2>::type,
+                                              typename _make_indices<N - N / 2>::type>::type;
+    };
+    template <> struct _make_indices<0> { using type = _indices<>; };
+    template <> struct _make_indices<1> { using type = _indices<0>; };
+
+    struct _name_table_view { // Runtime lookup into a _name_table, empty (value initialized) if no names were declared
+        enum : size_t { npos = (size_t) -1 };
+
+        const char *const *names;
+        size_t count;
+        const uint16_t *slots;
+        size_t slot_mask;
+        const uint16_t *seeds;
+        size_t group_mask;
+
+        bool empty() const { return count == 0; }
+        size_t find(const string_view &name) const { // One hash, two reads and one compare
+            if(empty()) return npos;
+            uint32_t hash = _name_hash(name);
+            size_t i = slots[_name_bucket(hash, seeds[_name_bucket(hash, 0, group_mask)], slot_mask)];
+            if(i != 0 && name == names[i - 1])
+                return i - 1;
+            return npos;
+        }
+    };
+
+    // Hash and displace: names are split into about N groups by one hash, then each group gets a seed that moves all
+    // of its names to free slots of about 2N. Groups are placed in order. Every loop is a binary recursion and sorting
+    // is a merge sort, so the constexpr depth stays logarithmic and the work about N log^2 N
+    template <size_t N>
+    class _name_table {
+        static_assert(N < 16384, "FIRE_NAMES(...) or FIRE_SUBCOMMANDS(...) has too many names");
+        static constexpr size_t _slot_count = _name_table_size(2 * N, 32), _group_count = _name_table_size(N);
+        static constexpr uint32_t _seed_end = 65536;
+
+        struct list { uint32_t v[N]; }; // Sort keys hold a group or slot above 16 bits of name index
+        struct seed_list { uint16_t v[_group_count]; };
+        struct slot_list { uint16_t v[_slot_count]; }; // Name index + 1, 0 if empty
+        struct start_list { uint32_t v[_group_count + 1]; };
+        struct layout { list hash; list sorted; start_list start; }; // Names sorted by group
+        struct placement { seed_list seeds; uint32_t used[_slot_count / 32]; }; // Seeds of placed groups, used slots
+
+        const char *_names[N];
+        slot_list _slots;
+        seed_list _seeds;
+
+        static constexpr uint32_t _group(uint32_t hash) { return _name_bucket(hash, 0, _group_count - 1); }
+        static constexpr uint32_t _slot(uint32_t hash, uint32_t seed) { return _name_bucket(hash, seed, _slot_count - 1); }
+        static constexpr size_t _mid(size_t lo, size_t hi) { return lo + (hi - lo) / 2; }
+        static constexpr size_t _min(size_t a, size_t b) { return a < b ? a : b; }
+
+        // Merge sort: element k of merging the sorted runs [left, left + ln) and [right, right + rn), found by
+        // binary searching the count i of elements taken from the left run
+        static constexpr size_t _split(const list &l, size_t left, size_t ln, size_t right, size_t rn, size_t k,
+                                       size_t lo, size_t hi) {
+            return lo >= hi ? lo : l.v[left + _mid(lo, hi)] < l.v[right + k - _mid(lo, hi) - 1] ?
+                   _split(l, left, ln, right, rn, k, _mid(lo, hi) + 1, hi) : _split(l, left, ln, right, rn, k, lo, _mid(lo, hi));
+        }
+        static constexpr uint32_t _merged_at(const list &l, size_t left, size_t ln, size_t right, size_t rn, size_t k, size_t i) {
+            return i < ln && (k - i >= rn || l.v[left + i] < l.v[right + k - i]) ? l.v[left + i] : l.v[right + k - i];
+        }
+        static constexpr uint32_t _merged(const list &l, size_t width, size_t p, size_t left) {
+            return _merged_at(l, left, _min(width, N - left), left + width, _min(width, N - _min(N, left + width)), p - left,
+                              _split(l, left, _min(width, N - left), left + width, _min(width, N - _min(N, left + width)),
+                                     p - left, p - left > _min(width, N - _min(N, left + width)) ?
+                                     p - left - _min(width, N - _min(N, left + width)) : 0, _min(p - left, _min(width, N - left))));
+        }
+        template <size_t... I>
+        static constexpr list _merge_pass(const list &l, size_t width, _indices<I...>) {
+            return list{{_merged(l, width, I, I - I % (2 * width))...}};
+        }
+        static constexpr list _sort(const list &l, size_t width = 1) {
+            return width >= N ? l : _sort(_merge_pass(l, width, typename _make_indices<N>::type()), 2 * width);
+        }
+        static constexpr size_t _lower(const list &sorted, uint32_t key, size_t lo = 0, size_t hi = N) {
+            return lo == hi ? lo : sorted.v[_mid(lo, hi)] < key ?
+                   _lower(sorted, key, _mid(lo, hi) + 1, hi) : _lower(sorted, key, lo, _mid(lo, hi));
+        }
+        static constexpr uint16_t _entry(const list &sorted, uint32_t slot, size_t k) {
+            return (uint16_t) (k < N && sorted.v[k] >> 16 == slot ? (sorted.v[k] & 0xffff) + 1 : 0);
+        }
+        template <size_t... G>
+        static constexpr start_list _starts(const list &sorted, _indices<G...>) {
+            return start_list{{(uint32_t) _lower(sorted, (uint32_t) G << 16)...}};
+        }
+
+        static constexpr uint32_t _hash_at(const layout &l, size_t k) { return l.hash.v[l.sorted.v[k] & 0xffff]; }
+        static constexpr bool _used(const placement &p, uint32_t slot) { return (p.used[slot / 32] >> (slot % 32)) & 1; }
+
+        // Whether the names at positions [lo, hi) of a group, placed with seed, miss slot
+        static constexpr bool _misses(const layout &l, uint32_t seed, uint32_t slot, size_t lo, size_t hi) {
+            return lo == hi || (hi - lo == 1 ? _slot(_hash_at(l, lo), seed) != slot :
+                                _misses(l, seed, slot, lo, _mid(lo, hi)) && _misses(l, seed, slot, _mid(lo, hi), hi));
+        }
+        static constexpr bool _fits(const layout &l, const placement &p, size_t first, uint32_t seed, size_t lo, size_t hi) {
+            return hi - lo == 1 ? ! _used(p, _slot(_hash_at(l, lo), seed)) &&
+                                  _misses(l, seed, _slot(_hash_at(l, lo), seed), first, lo) :
+                   _fits(l, p, first, seed, lo, _mid(lo, hi)) && _fits(l, p, first, seed, _mid(lo, hi), hi);
+        }
+        static constexpr bool _differs(const layout &l, size_t lo, size_t hi, size_t k) {
+            return lo == hi || (hi - lo == 1 ? _hash_at(l, lo) != _hash_at(l, k) :
+                                _differs(l, lo, _mid(lo, hi), k) && _differs(l, _mid(lo, hi), hi, k));
+        }
+        static constexpr bool _distinct(const layout &l, size_t first, size_t lo, size_t hi) { // Hashes within a group
+            return hi - lo == 1 ? _differs(l, first, lo, lo) :
+                   _distinct(l, first, lo, _mid(lo, hi)) && _distinct(l, first, _mid(lo, hi), hi);
+        }
+        static constexpr uint32_t _search(const layout &l, const placement &p, size_t group, uint32_t lo, uint32_t hi) {
+            return hi - lo == 1 ? (_fits(l, p, l.start.v[group], lo, l.start.v[group], l.start.v[group + 1]) ? lo : 0) :
+                   _search_rest(_search(l, p, group, lo, (uint32_t) _mid(lo, hi)), l, p, group, (uint32_t) _mid(lo, hi), hi);
+        }
+        static constexpr uint32_t _search_rest(uint32_t found, const layout &l, const placement &p, size_t group,
+                                               uint32_t lo, uint32_t hi) {
+            return found ? found : _search(l, p, group, lo, hi);
+        }
+
+        static constexpr uint32_t _bits(const layout &l, uint32_t seed, size_t word, size_t lo, size_t hi) {
+            return hi - lo == 1 ? (_slot(_hash_at(l, lo), seed) / 32 == word ? 1u << (_slot(_hash_at(l, lo), seed) % 32) : 0) :
+                   _bits(l, seed, word, lo, _mid(lo, hi)) | _bits(l, seed, word, _mid(lo, hi), hi);
+        }
+        template <size_t... G, size_t... W>
+        static constexpr placement _with_seed(const layout &l, const placement &p, size_t group, uint32_t seed,
+                                              _indices<G...>, _indices<W...>) {
+            return seed == 0 ? throw "FIRE_NAMES(...) or FIRE_SUBCOMMANDS(...) names can't be hashed" :
+                   placement{{{(G == group ? (uint16_t) seed : p.seeds.v[G])...}},
+                             {(p.used[W] | _bits(l, seed, W, l.start.v[group], l.start.v[group + 1]))...}};
+        }
+        static constexpr placement _place_group(const layout &l, const placement &p, size_t group) {
+            return l.start.v[group] == l.start.v[group + 1] ? p :
+                   ! _distinct(l, l.start.v[group], l.start.v[group], l.start.v[group + 1]) ?
+                   throw "FIRE_NAMES(...) or FIRE_SUBCOMMANDS(...) contains duplicate names" :
+                   _with_seed(l, p, group, _search(l, p, group, 1, _seed_end), typename _make_indices<_group_count>::type(),
+                              typename _make_indices<_slot_count / 32>::type());
+        }
+        static constexpr placement _place(const layout &l, const placement &p, size_t lo = 0, size_t hi = _group_count) {
+            return hi - lo == 1 ? _place_group(l, p, lo) : _place(l, _place(l, p, lo, _mid(lo, hi)), _mid(lo, hi), hi);
+        }
+
+        template <size_t... S, typename... Names>
+        constexpr _name_table(_indices<S...>, const seed_list &seeds, const list &sorted_slots, Names... names):
+            _names{names...}, _slots{{_entry(sorted_slots, (uint32_t) S, _lower(sorted_slots, (uint32_t) S << 16))...}},
+            _seeds(seeds) {}
+
+        template <size_t... I, typename... Names>
+        constexpr _name_table(_indices<I...>, const list &hs, const seed_list &seeds, Names... names):
+            _name_table(typename _make_indices<_slot_count>::type(), seeds,
+                        _sort(list{{_slot(hs.v[I], seeds.v[_group(hs.v[I])]) << 16 | (uint32_t) I...}}), names...) {}
+
+        template <size_t... I, typename... Names>
+        constexpr _name_table(_indices<I...> indices, const layout &l, Names... names):
+            _name_table(indices, l.hash, _place(l, placement{{{}}, {}}).seeds, names...) {}
+
+        template <size_t... I, typename... Names>
+        constexpr _name_table(_indices<I...> indices, const list &hs, const list &sorted, Names... names):
+            _name_table(indices, layout{hs, sorted, _starts(sorted, typename _make_indices<_group_count + 1>::type())},
+                        names...) {}
+
+        template <size_t... I, typename... Names>
+        constexpr _name_table(_indices<I...> indices, const list &hs, Names... names):
+            _name_table(indices, hs, _sort(list{{_group(hs.v[I]) << 16 | (uint32_t) I...}}), names...) {}
+
+    public:
+        template <typename... Names>
+        constexpr explicit _name_table(Names... names):
+            _name_table(typename _make_indices<N>::type(), list{{_name_hash(names)...}}, names...) {}
+
+        constexpr size_t size() const { return N; }
+        _name_table_view view() const { return {_names, N, _slots.v, _slot_count - 1, _seeds.v, _group_count - 1}; }
+    };
+
+    template <typename... S>
+    constexpr _name_table<sizeof...(S)> _make_name_table(S... names) { return _name_table<sizeof...(S)>(names...); }
+
+    inline int count_hyphens(const string_view &s);
+    inline std::string without_hyphens(const std::string &s);
+
+    enum class _conversion { ok, invalid, out_of_range, negative };
+
+    template <typename T>
+    inline _conversion _parse_integer(const string_view &s, T &out);
+    template <typename T>
+    inline _conversion _parse_real(const string_view &s, T &out);
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value && ! std::is_same<T, bool>::value>::type* = nullptr>
+    inline _conversion _parse_value(const string_view &value, T &out) { return _parse_integer(value, out); }
+    template <typename T, typename std::enable_if<std::is_floating_point<T>::value>::type* = nullptr>
+    inline _conversion _parse_value(const string_view &value, T &out) { return _parse_real(value, out); }
+    template <typename T, typename std::enable_if<std::is_same<T, std::string>::value || std::is_same<T, string_view>::value>::type* = nullptr>
+    inline _conversion _parse_value(const string_view &value, T &out) { out = T(value); return _conversion::ok; }
+    template <typename T, typename std::enable_if<std::is_same<T, const char *>::value>::type* = nullptr>
+    inline _conversion _parse_value(const string_view &value, T &out) { out = value.c_str(); return _conversion::ok; }
+
+    template <typename T> // Converted values pointing to the argument, which must be null-terminated
+    using _needs_terminator = std::integral_constant<bool, std::is_same<T, string_view>::value ||
+                                                           std::is_same<T, const char *>::value>;
+
+    // Bulk conversion of vector arguments, vectorized for integral, float and double elements
+    template <typename T>
+    using _simd_convertible = std::integral_constant<bool, (std::is_integral<T>::value && ! std::is_same<T, bool>::value) ||
+                                                           std::is_same<T, float>::value || std::is_same<T, double>::value>;
+
+    struct _simd_token { // Short decimal token, read by the vectorized kernels
+        const char *begin; // After the sign
+        size_t length; // 1 to 16 characters
+        bool negative;
+        int exponent; // Of a real, without frac_digits
+        int frac_digits; // Set by the kernels
+    };
+
+    inline int _simd_level(); // 0: scalar, 1: SSE4.2, 2: AVX2
+    inline bool _simd_prepare(const string_view &s, bool real, _simd_token &token);
+
+    // Converts count values into out, returns the index of the first failure (and sets result) or count
+    template <typename T>
+    inline size_t _parse_range(const string_view *values, size_t count, T *out, _conversion &result);
+
+    class _bigint { // Unsigned integer of arbitrary size, used for rounding long real numbers exactly
+        std::vector<uint32_t> _limbs; // Little endian, no leading zero limbs
+
+        inline void _trim() { while(! _limbs.empty() && _limbs.back() == 0) _limbs.pop_back(); }
+    public:
+        _bigint(uint32_t value = 0) { if(value) _limbs.push_back(value); }
+
+        inline void mul_add(uint32_t mul, uint32_t add);
+        inline void mul_pow10(long long exp);
+        inline void shift_left(size_t bits);
+        inline void shift_right_one();
+        inline void subtract(const _bigint &other);
+        inline size_t bit_length() const;
+        inline static int compare(const _bigint &a, const _bigint &b);
+    };
+
+    struct env { // Names an environment variable used when the argument isn't given: fire::arg({"--threads", fire::env("APP_THREADS")})
+        const char *name;
+        constexpr explicit env(const char *name_): name(name_) {}
+    };
+
+    // Declaration rules shared by identifier::_validate at runtime and FIRE_ID(...) at compile time
+    enum class _declaration_error {
+        none, hyphens, descr_twice, short_twice, short_length, short_digit, long_twice, long_length,
+        index_twice, env_twice, name_and_index, no_name, pos_name_without_index
+    };
+
+    struct _declaration_state {
+        int descrs, shorts, longs, positions, pos_names, envs;
+        _declaration_error error;
+    };
+
+    constexpr const char *_declaration_message(_declaration_error error) {
+        return error == _declaration_error::hyphens ? "Identifier entry must prefix either: 0 hyphens for description,"
+                                                      " 1 hyphen for short-hand name, 2 hyphens for long name" :
+               error == _declaration_error::descr_twice ? "Can't specify descriptions twice" :
+               error == _declaration_error::short_twice ? "Can't specify shorthands twice" :
+               error == _declaration_error::short_length ? "Single hyphen shorthand must be one character" :
+               error == _declaration_error::short_digit ? "Argument can't start with a number" :
+               error == _declaration_error::long_twice ? "Can't specify long names twice" :
+               error == _declaration_error::long_length ? "Two hyphen name must have at least two characters" :
+               error == _declaration_error::index_twice ? "Can't specify index twice" :
+               error == _declaration_error::env_twice ? "Can't specify environment variables twice" :
+               error == _declaration_error::name_and_index ? "Can't specify both name and index" :
+               error == _declaration_error::no_name ? "Argument must be specified with at least one of the following:"
+                                                      " shorthand, long name or index" :
+               error == _declaration_error::pos_name_without_index ? "Positional name requires the argument to be positional" :
+               "";
+    }
+
+    constexpr _declaration_state _declaration_failed(_declaration_state st, _declaration_error error) {
+        return st.error != _declaration_error::none ? st :
+               _declaration_state{st.descrs, st.shorts, st.longs, st.positions, st.pos_names, st.envs, error};
+    }
+
+    constexpr int _entry_hyphens(const char *s, size_t size, size_t i = 0) {
+        return i < size && s[i] == '-' ? 1 + _entry_hyphens(s, size, i + 1) : 0;
+    }
+
+    constexpr bool _entry_is_pos_name(const char *s, size_t size) {
+        return size >= 2 && s[0] == '<' && s[size - 1] == '>';
+    }
+
+    constexpr _declaration_state _declaration_name(_declaration_state st, const char *name, size_t size) {
+        return st.error != _declaration_error::none ? st :
+               _entry_is_pos_name(name, size) ?
+                   _declaration_state{st.descrs, st.shorts, st.longs, st.positions, st.pos_names + 1, st.envs, st.error} :
+               _entry_hyphens(name, size) > 2 ? _declaration_failed(st, _declaration_error::hyphens) :
+               _entry_hyphens(name, size) == 0 ?
+                   (st.descrs > 0 ? _declaration_failed(st, _declaration_error::descr_twice) :
+                    _declaration_state{1, st.shorts, st.longs, st.positions, st.pos_names, st.envs, st.error}) :
+               _entry_hyphens(name, size) == 1 ?
+                   (st.shorts > 0 ? _declaration_failed(st, _declaration_error::short_twice) :
+                    size != 2 ? _declaration_failed(st, _declaration_error::short_length) :
+                    name[1] >= '0' && name[1] <= '9' ? _declaration_failed(st, _declaration_error::short_digit) :
+                    _declaration_state{st.descrs, 1, st.longs, st.positions, st.pos_names, st.envs, st.error}) :
+                   (st.longs > 0 ? _declaration_failed(st, _declaration_error::long_twice) :
+                    size < 4 ? _declaration_failed(st, _declaration_error::long_length) :
+                    _declaration_state{st.descrs, st.shorts, 1, st.positions, st.pos_names, st.envs, st.error});
+    }
+
+    constexpr _declaration_state _declaration_index(_declaration_state st) {
+        return st.positions > 0 ? _declaration_failed(st, _declaration_error::index_twice) :
+               _declaration_state{st.descrs, st.shorts, st.longs, 1, st.pos_names, st.envs, st.error};
+    }
+
+    constexpr _declaration_state _declaration_env(_declaration_state st) {
+        return st.envs > 0 ? _declaration_failed(st, _declaration_error::env_twice) :
+               _declaration_state{st.descrs, st.shorts, st.longs, st.positions, st.pos_names, 1, st.error};
+    }
+
+    constexpr _declaration_state _declaration_finish(_declaration_state st) { // Rules spanning several entries
+        return st.positions > 0 && st.shorts + st.longs > 0 ? _declaration_failed(st, _declaration_error::name_and_index) :
+               st.positions + st.shorts + st.longs == 0 ? _declaration_failed(st, _declaration_error::no_name) :
+               st.pos_names > 0 && st.positions == 0 ? _declaration_failed(st, _declaration_error::pos_name_without_index) :
+               st;
+    }
+
+    constexpr size_t _literal_size(const char *s) { return *s ? 1 + _literal_size(s + 1) : 0; }
+
+    constexpr _declaration_state _declaration_add(_declaration_state st, int) { return _declaration_index(st); }
+    constexpr _declaration_state _declaration_add(_declaration_state st, env) { return _declaration_env(st); }
+    constexpr _declaration_state _declaration_add(_declaration_state st, const char *name) {
+        return _declaration_name(st, name, _literal_size(name));
+    }
+
+    constexpr _declaration_state _declaration_fold(_declaration_state st) { return st; }
+    template <typename E, typename... R>
+    constexpr _declaration_state _declaration_fold(_declaration_state st, E entry, R... rest) {
+        return _declaration_fold(_declaration_add(st, entry), rest...);
+    }
+
+    constexpr bool _declaration_valid(_declaration_state st) {
+        return st.error == _declaration_error::none ? true : throw _declaration_message(st.error);
+    }
+
+    template <typename... E>
+    constexpr bool _validate_declaration(E... entries) {
+        return _declaration_valid(_declaration_finish(
+                _declaration_fold(_declaration_state{0, 0, 0, 0, 0, 0, _declaration_error::none}, entries...)));
+    }
+
+    struct _checked_declaration { // Created by FIRE_ID(...) after validation at compile time
+        std::vector<std::string> names;
+        optional<int> pos;
+        optional<std::string> env_name;
+
+        template <typename... E>
+        explicit _checked_declaration(std::true_type, E... entries) { names.reserve(sizeof...(E)); _add(entries...); }
+
+    private:
+        void _add() {}
+        template <typename... R>
+        void _add(int entry, R... rest) { pos = entry; _add(rest...); }
+        template <typename... R>
+        void _add(const char *entry, R... rest) { names.emplace_back(entry); _add(rest...); }
+        template <typename... R>
+        void _add(env entry, R... rest) { env_name = std::string(entry.name); _add(rest...); }
     };
 
     class identifier {
         optional<int> _pos;
         optional<std::string> _short_name, _long_name, _pos_name, _descr;
+        optional<std::string> _env; // Environment variable used when the argument isn't given
         bool _vector = false;
         bool _optional = false; // Only use for operator<
 
         std::string _help, _longer;
 
-        inline static void _check_name(const std::string &name);
     public:
+        inline static void _validate(const std::vector<std::string> &names, const std::vector<int> &positions,
+                                     const std::vector<std::string> &envs);
         inline static std::string prepend_hyphens(const std::string &name);
 
         inline identifier(optional<std::string> descr=optional<std::string>());
-        inline identifier(const std::vector<std::string> &names, optional<int> pos);
+        inline identifier(const std::vector<std::string> &names, optional<int> pos, bool validated = false);
 
         inline bool operator<(const identifier &other) const;
         inline bool overlaps(const identifier &other) const;
@@ -94,12 +591,19 @@ namespace fire {
         inline std::string help() const { return _help; }
         inline std::string longer() const { return _longer; }
         inline optional<int> get_pos() const { return _pos; }
+        inline const optional<std::string>& get_short_name() const { return _short_name; }
+        inline const optional<std::string>& get_long_name() const { return _long_name; }
+        inline const optional<std::string>& get_env() const { return _env; }
         inline void set_optional(bool optional) { _optional = optional; }
+        inline void set_env(const optional<std::string> &env) { _env = env; }
         inline bool vector() const { return _vector; }
 
         inline std::string get_descr() const { return _descr.value_or(""); }
     };
 
+    template <typename T>
+    inline std::string _conversion_error(_conversion result, const string_view &value, const identifier &id);
+
     template<typename ORDER, typename VALUE>
     class _first {
         ORDER _order;
@@ -112,38 +616,368 @@ namespace fire {
         bool empty() const { return _empty; }
     };
 
+    class _arena { // Bump allocator, all memory is freed at once with the arena
+        std::vector<std::unique_ptr<char[]>> _blocks;
+        char *_next = nullptr;
+        size_t _left = 0;
+        size_t _block_size = 4096;
+
+    public:
+        _arena() = default;
+        _arena(const _arena &) = delete;
+        _arena& operator=(const _arena &) = delete;
+
+        inline void* allocate(size_t size, size_t alignment);
+        inline string_view copy(const string_view &s); // Null-terminated copy
+    };
+
+    template <typename T>
+    struct _arena_allocator { // Allocates from a shared arena, or from the heap if there's none
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+        std::shared_ptr<_arena> arena;
+
+        _arena_allocator() = default;
+        explicit _arena_allocator(std::shared_ptr<_arena> arena_): arena(std::move(arena_)) {}
+        template <typename U>
+        _arena_allocator(const _arena_allocator<U> &other): arena(other.arena) {}
+
+        T* allocate(size_t n) {
+            if(arena)
+                return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+        }
+        void deallocate(T *p, size_t) {
+            if(! arena)
+                ::operator delete(p);
+        }
+
+        template <typename U>
+        bool operator==(const _arena_allocator<U> &other) const { return arena == other.arena; }
+        template <typename U>
+        bool operator!=(const _arena_allocator<U> &other) const { return arena != other.arena; }
+    };
+
+    template <typename T>
+    using _arena_vector = std::vector<T, _arena_allocator<T>>;
+    template <typename K, typename V, typename H = std::hash<K>>
+    using _arena_map = std::unordered_map<K, V, H, std::equal_to<K>, _arena_allocator<std::pair<const K, V>>>;
+    template <typename K, typename H = std::hash<K>>
+    using _arena_set = std::unordered_set<K, H, std::equal_to<K>, _arena_allocator<K>>;
+
+#ifdef _WIN32
+    constexpr bool _backslash_escapes = false; // Keeps paths like C:\dir\file, backslash only escapes a double quote
+#else
+    constexpr bool _backslash_escapes = true;
+#endif
+
+    // Splits data into whitespace separated tokens. Plain tokens are views into data, which isn't modified, tokens
+    // with quotes or escapes are unquoted into null-terminated copies
+    inline void _tokenize(const char *data, size_t size, _arena &copies, _arena_vector<string_view> &tokens,
+                          bool backslash_escapes = _backslash_escapes);
+
+    class _mapped_file { // Read-only memory mapping of a file, pages are shared with the page cache
+        char *_data = nullptr;
+        size_t _size = 0;
+        bool _open = false, _mapped = false;
+        std::vector<char> _buffer; // Used when memory mapping is unavailable
+
+    public:
+        inline explicit _mapped_file(const char *path);
+        inline ~_mapped_file();
+        _mapped_file(const _mapped_file &) = delete;
+        _mapped_file& operator=(const _mapped_file &) = delete;
+
+        bool is_open() const { return _open; }
+        const char* data() const { return _data; }
+        size_t size() const { return _size; }
+    };
+
+    class _response_file { // Memory mapped @file, plain tokens are views into the mapping
+        _mapped_file _file;
+        _arena _copies; // Unquoted tokens, and tokens null-terminated on query
+
+    public:
+        explicit _response_file(const char *path): _file(path) {}
+
+        bool is_open() const { return _file.is_open(); }
+        bool contains(const string_view &token) const {
+            return token.data() >= _file.data() && token.data() < _file.data() + _file.size();
+        }
+        inline void tokenize(_arena_vector<string_view> &tokens);
+        string_view terminated(const string_view &token) { return _copies.copy(token); }
+    };
+
+    class _config_file { // Memory mapped --fire-config file of INI sections and "key = value" lines
+        struct _entry {
+            string_view key;
+            const char *value;
+            uint32_t size;
+            uint32_t hash;
+            bool terminated; // Copied with a null terminator on first query, the mapping is never written
+        };
+
+        _mapped_file _file;
+        std::string _path, _error; // _error describes the first malformed line
+        _arena _strings; // Keys within sections as "section.key" and queried values
+        std::vector<_entry> _entries; // In file order, views into the file
+        std::vector<uint32_t> _slots; // Open addressing table of 1 + index into _entries, 0 for empty slots
+
+        inline void _index_lines();
+        inline uint32_t& _find_slot(const string_view &key, uint32_t hash);
+        inline void _insert(const string_view &key, const char *value, size_t size);
+
+    public:
+        inline explicit _config_file(const char *path);
+        _config_file(const _config_file &) = delete;
+        _config_file& operator=(const _config_file &) = delete;
+
+        bool is_open() const { return _file.is_open(); }
+        const std::string& path() const { return _path; }
+        const std::string& error() const { return _error; }
+        inline optional<string_view> get(const string_view &key);
+    };
+
+    using _environment_map = _arena_map<string_view, string_view, _string_view_hash>;
+
+    class _argument_cache { // --fire-cache=FILE: converted values of the last successful run with the same inputs
+        struct _file_stamp {
+            std::string path;
+            int64_t seconds, nanoseconds;
+            uint64_t size;
+        };
+        struct _env_stamp {
+            std::string name;
+            uint8_t present;
+            uint64_t hash;
+        };
+
+        std::string _path;
+        uint64_t _key; // Hash of argv and parser settings
+        std::vector<_file_stamp> _files; // Response and config files read while parsing
+        std::vector<_env_stamp> _env; // Variables named by fire::env(...)
+        std::unique_ptr<_mapped_file> _file; // Loaded cache, string_view values point into it
+        const char *_entries = nullptr, *_next = nullptr, *_end = nullptr; // Values in query order
+        bool _hit = false, _recordable = true, _saved = false;
+        std::string _record; // Values of this run, saved once all arguments are converted without errors
+
+        inline static bool _stamp(const std::string &path, _file_stamp &stamp);
+
+        template <typename T, typename std::enable_if<std::is_arithmetic<T>::value>::type* = nullptr>
+        void _put(const T &value) { _record.append(reinterpret_cast<const char *>(&value), sizeof(T)); }
+        void _put(const string_view &value) {
+            _put((uint64_t) value.size());
+            _record.append(value.data(), value.size());
+            _record.push_back('\0');
+        }
+        void _put(const std::string &value) { _put(string_view(value)); }
+        void _put(const char *value) { _put(string_view(value)); }
+        template <typename T>
+        void _put(const optional<T> &value) {
+            _put((uint8_t) value.has_value());
+            if(value.has_value())
+                _put(*value);
+        }
+        template <typename T>
+        void _put(const std::vector<T> &values) {
+            _put((uint64_t) values.size());
+            _put_elements(values, std::is_arithmetic<T>());
+        }
+        template <typename T>
+        void _put_elements(const std::vector<T> &values, std::true_type) {
+            _record.append(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T));
+        }
+        template <typename T>
+        void _put_elements(const std::vector<T> &values, std::false_type) { for(const T &value: values) _put(value); }
+
+        template <typename T, typename std::enable_if<std::is_arithmetic<T>::value>::type* = nullptr>
+        bool _get(T &value) {
+            if((size_t) (_end - _next) < sizeof(T))
+                return false;
+            std::memcpy(&value, _next, sizeof(T));
+            _next += sizeof(T);
+            return true;
+        }
+        bool _get(string_view &value) {
+            uint64_t size;
+            if(! _get(size) || size >= (uint64_t) (_end - _next) || _next[size] != '\0')
+                return false;
+            value = string_view(_next, (size_t) size);
+            _next += size + 1;
+            return true;
+        }
+        bool _get(std::string &value) {
+            string_view view;
+            if(! _get(view))
+                return false;
+            value = view.str();
+            return true;
+        }
+        bool _get(const char *&value) {
+            string_view view;
+            if(! _get(view))
+                return false;
+            value = view.c_str();
+            return true;
+        }
+        template <typename T>
+        bool _get(optional<T> &value) {
+            uint8_t present;
+            T inner = T();
+            if(! _get(present) || (present && ! _get(inner)))
+                return false;
+            value = present ? optional<T>(inner) : optional<T>();
+            return true;
+        }
+        template <typename T>
+        bool _get(std::vector<T> &values) {
+            uint64_t size;
+            if(! _get(size) || size > (uint64_t) (_end - _next))
+                return false;
+            return _get_elements(values, (size_t) size, std::is_arithmetic<T>());
+        }
+        template <typename T>
+        bool _get_elements(std::vector<T> &values, size_t size, std::true_type) {
+            if(size > (size_t) (_end - _next) / sizeof(T))
+                return false;
+            values.resize(size);
+            std::memcpy(values.data(), _next, size * sizeof(T));
+            _next += size * sizeof(T);
+            return true;
+        }
+        template <typename T>
+        bool _get_elements(std::vector<T> &values, size_t size, std::false_type) {
+            values.resize(size);
+            for(T &value: values)
+                if(! _get(value))
+                    return false;
+            return true;
+        }
+
+    public:
+        _argument_cache(std::string path, uint64_t key): _path(std::move(path)), _key(key) {}
+        _argument_cache(const _argument_cache &) = delete;
+        _argument_cache& operator=(const _argument_cache &) = delete;
+
+        inline bool load(const _environment_map &environment); // True if the inputs of the cached run are unchanged
+        bool hit() const { return _hit; }
+        bool exhausted() const { return _next == _end; }
+        inline void recover(); // Records from here on, keeping values that were already read
+
+        template <typename T>
+        bool read(uint64_t schema, T &value) { // Next value, if it was converted for the same declaration
+            const char *entry = _next;
+            uint64_t stored;
+            if(_hit && _get(stored) && stored == schema && _get(value))
+                return true;
+            _next = entry;
+            return false;
+        }
+        template <typename T>
+        void write(uint64_t schema, const T &value) {
+            if(! _hit) {
+                _put(schema);
+                _put(value);
+            }
+        }
+        inline void add_file(const std::string &path);
+        inline void add_env(const std::string &name, const optional<string_view> &value);
+        void unsupported() { _recordable = false; } // Argument types that can't be cached, e.g. fire::stream
+        inline void save();
+    };
+
+    // Reserved --fire-... arguments a program accepts, each one only if it opts in with the matching define
+    enum _feature: unsigned {
+        _feature_cache = 1u, _feature_batch = 2u, _feature_complete = 4u, _feature_config = 8u, _feature_response_files = 16u
+    };
+
     class _matcher {
-        std::string _executable;
-        std::vector<std::string> _positional;
-        std::vector<std::pair<std::string, optional<std::string>>> _named;
-        std::vector<identifier> _queried;
+        static constexpr size_t _not_given = (size_t) -1;
+        struct _name_slot {
+            size_t named = _not_given; // Index of the first occurrence in _named
+            bool queried = false;
+        };
+
+        // Containers allocate from _memory, views point into argv or response files, which outlive the matcher
+        std::shared_ptr<_arena> _memory;
+        string_view _executable;
+        _arena_vector<string_view> _positional;
+        _arena_vector<std::pair<string_view, optional<string_view>>> _named;
+        _arena_map<string_view, _name_slot, _string_view_hash> _name_index; // Hyphened name -> slot
+        _environment_map _environment; // Variable -> value, views into environ
+        _name_table_view _declared_names = _name_table_view(); // Names from FIRE_NAMES(...), if any
+        _arena_vector<_name_slot> _declared_slots; // Slots of declared names, by table index
+        _arena_set<string_view, _string_view_hash> _queried_absent; // Queried names not given on command line
+        _arena_set<int> _queried_positions;
+        bool _all_positional_queried = false; // Set by arg::vector
+        std::vector<std::shared_ptr<_response_file>> _response_files; // Keep token storage alive
+        std::vector<std::shared_ptr<_config_file>> _config_files; // From --fire-config=FILE, later files take precedence
+        std::shared_ptr<_argument_cache> _cache; // From --fire-cache=FILE
+        std::vector<identifier> _cache_served; // Arguments served from the cache, replayed if it misses later
+        int _argc = 0;
+        const char **_argv = nullptr; // Parsed on construction, or on a cache miss
         _first<identifier, std::string> _deferred_error;
         int _main_argc = 0;
         bool _space_assignment = false;
         bool _strict = false;
         bool _help_flag = false;
+        unsigned _features = 0; // --fire-cache=FILE, --fire-config=FILE and @FILE are read only if the program opts in
 
     public:
         enum class arg_type { string_t, bool_t, none_t };
 
         inline _matcher() = default;
-        inline _matcher(int argc, const char **argv, int main_argc, bool space_assignment, bool strict);
+        inline _matcher(int argc, const char **argv, int main_argc, bool space_assignment, bool strict,
+                        const _name_table_view &declared_names = _name_table_view(), unsigned features = 0);
 
         inline void check(bool dec_main_argc);
         inline void check_named();
         inline void check_positional();
 
-        inline std::pair<std::string, arg_type> get_and_mark_as_queried(const identifier &id);
+        inline const _name_slot* find_slot(const string_view &name) const;
+        _name_slot* find_slot(const string_view &name) {
+            return const_cast<_name_slot *>(static_cast<const _matcher *>(this)->find_slot(name));
+        }
+        inline bool is_queried(const identifier &id) const;
+        inline void mark_as_queried(const identifier &id);
+        inline std::pair<string_view, arg_type> get_and_mark_as_queried(const identifier &id);
+        // Value of an argument not given on command line, from fire::env(...) or a config file, and its origin
+        inline optional<std::pair<string_view, std::string>> get_fallback(const identifier &id);
+        // Tokens of response files aren't null-terminated, they are copied once a const char * might be needed
+        inline string_view terminated(const string_view &value);
+        inline void terminate_positional();
+        bool caching() const { return _cache != nullptr; }
+        template <typename T>
+        inline bool cache_load(const identifier &id, uint64_t schema, T &value);
+        template <typename T>
+        inline void cache_store(const identifier &id, uint64_t schema, const T &value);
+        inline void cache_unsupported();
+        inline void cache_recover(); // Parses argv after all, once a cached value doesn't match its declaration
+        inline void open_cache(int argc, const char **argv);
+        inline void parse_command_line();
         inline void parse(int argc, const char **argv);
-        inline std::vector<std::string> to_vector_string(int n_strings, const char **strings);
-        inline std::tuple<std::vector<std::string>, std::vector<std::string>>
-                separate_named_positional(const std::vector<std::string> &raw);
-        inline std::vector<std::pair<std::string, bool>> split_equations(const std::vector<std::string> &named);
-        inline std::vector<std::pair<std::string, optional<std::string>>>
-                assign_named_values(const std::vector<std::pair<std::string, bool>> &split);
-        inline const std::string& get_executable() { return _executable; }
-        inline size_t pos_args() { return _positional.size(); }
-        inline bool deferred_assert(const identifier &id, bool pass, const std::string &msg);
+        inline void index_environment();
+        inline _arena_vector<string_view> expand_response_files(const _arena_vector<string_view> &raw);
+        inline _arena_vector<string_view> load_config_files(const _arena_vector<string_view> &raw);
+        inline _arena_vector<string_view> to_vector_string_view(int n_strings, const char **strings);
+        inline std::tuple<_arena_vector<string_view>, _arena_vector<string_view>>
+                separate_named_positional(const _arena_vector<string_view> &raw);
+        inline _arena_vector<std::pair<string_view, bool>> split_equations(const _arena_vector<string_view> &named);
+        inline _arena_vector<std::pair<string_view, optional<string_view>>>
+                assign_named_values(const _arena_vector<std::pair<string_view, bool>> &split);
+        inline static string_view expanded_shorthand(char c);
+        inline std::string get_executable() const { return _executable; }
+        inline const _arena_vector<string_view>& get_positional() const { return _positional; }
+        inline const std::vector<std::shared_ptr<_response_file>>& get_response_files() const { return _response_files; }
+        inline bool help_requested() const { return _help_flag; }
+        _arena_allocator<char> get_allocator() const { return _arena_allocator<char>(_memory); }
+        inline void release();
+        inline bool deferred_assert(const identifier &id, bool pass, const char *msg); // String is built on failure
+        template <typename F, typename = decltype(std::string(std::declval<const F &>()()))>
+        inline bool deferred_assert(const identifier &id, bool pass, const F &build_msg); // Builds message on failure
     };
 
 
@@ -157,56 +991,176 @@ namespace fire {
         };
 
     private:
-        std::vector<std::pair<identifier, log_elem>> _params;
+        _arena_vector<std::pair<identifier, log_elem>> _params;
 
         inline std::string _make_printable(const identifier &id, const log_elem &elem, bool verbose);
         inline void _add_to_help(std::string &usage, std::string &options,
                                  const identifier &id, const log_elem &elem, size_t margin);
     public:
+        _help_logger() = default;
+        explicit _help_logger(const _arena_allocator<char> &allocator): _params(allocator) {}
+
         inline void print_help();
+        inline std::string help_text();
         inline void log(const identifier &name, const log_elem &elem);
     };
 
+    struct _parser_state { // Everything a single parse writes to
+        _matcher matcher;
+        _help_logger help_logger;
+        on_error mode = on_error::exit;
+        unsigned features = 0; // Files the matcher may read, see parser::enable_cache, enable_config and enable_response_files
+    };
+
     template <typename T_VOID = void>
     struct _storage {
-        static _matcher matcher;
-        static _help_logger help_logger;
+        static _parser_state global; // Used by init_and_run and whenever no fire::parser is running
+        static thread_local _parser_state *active; // Set by fire::parser::run for its own thread only
+
+        static _parser_state& current() { return active ? *active : global; }
+        static _matcher& matcher() { return current().matcher; }
+        static _help_logger& help_logger() { return current().help_logger; }
     };
 
     template <typename T_VOID>
-    _matcher _storage<T_VOID>::matcher;
+    _parser_state _storage<T_VOID>::global;
 
     template <typename T_VOID>
-    _help_logger _storage<T_VOID>::help_logger;
+    thread_local _parser_state *_storage<T_VOID>::active = nullptr;
 
     using _ = _storage<void>;
 
+    inline void release(); // Frees parser memory, call from fired_main once arguments are converted
+
+#ifdef FIRE_TRACE
+#if defined(__GNUC__) || defined(__clang__)
+#define FIRE_TRACE_NOINLINE_ __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define FIRE_TRACE_NOINLINE_ __declspec(noinline)
+#else
+#define FIRE_TRACE_NOINLINE_
+#endif
+
+    template <typename T_VOID = void>
+    struct _trace_storage { // Compiled in with -DFIRE_TRACE, see _trace_scope
+        // Phases are kept per thread, so concurrent parsers don't mix their phases. Allocations are counted for
+        // the whole process, and the first thread to finish writes the only record
+        static std::atomic<size_t> allocations, bytes; // Counted by operator new of FIRE(...)
+        static thread_local size_t own_allocations, own_bytes; // Made by tracing itself, not reported for enclosing phases
+        static thread_local std::vector<std::string> phases; // JSON objects of finished phases
+        static thread_local int depth; // Number of open phases
+        static thread_local bool pending; // The record is written once the outermost open phase finishes
+        static std::atomic<bool> emitted;
+
+        static void count_allocation(size_t size) { ++allocations; bytes += size; }
+
+        // Heap of the operator new replaced by FIRE(...). Kept out of line, so compilers don't pair the inlined
+        // malloc and free with new and delete expressions (GCC -Wmismatched-new-delete)
+        FIRE_TRACE_NOINLINE_ static void* allocate(size_t size) {
+            count_allocation(size);
+            if(void *p = std::malloc(size ? size : 1))
+                return p;
+            throw std::bad_alloc();
+        }
+        FIRE_TRACE_NOINLINE_ static void deallocate(void *p) noexcept { std::free(p); }
+    };
+
+    template <typename T_VOID> std::atomic<size_t> _trace_storage<T_VOID>::allocations(0);
+    template <typename T_VOID> std::atomic<size_t> _trace_storage<T_VOID>::bytes(0);
+    template <typename T_VOID> thread_local size_t _trace_storage<T_VOID>::own_allocations = 0;
+    template <typename T_VOID> thread_local size_t _trace_storage<T_VOID>::own_bytes = 0;
+    template <typename T_VOID> thread_local std::vector<std::string> _trace_storage<T_VOID>::phases;
+    template <typename T_VOID> thread_local int _trace_storage<T_VOID>::depth = 0;
+    template <typename T_VOID> thread_local bool _trace_storage<T_VOID>::pending = false;
+    template <typename T_VOID> std::atomic<bool> _trace_storage<T_VOID>::emitted(false);
+
+    using _trace = _trace_storage<void>;
+
+    class _trace_scope { // Records wall time and heap allocations of a parser phase
+        const char *_phase;
+        std::string _name;
+        std::chrono::steady_clock::time_point _start;
+        size_t _allocations, _bytes, _own_allocations, _own_bytes;
+
+    public:
+        inline explicit _trace_scope(const char *phase, std::string name = "");
+        inline ~_trace_scope();
+        _trace_scope(const _trace_scope &) = delete;
+        _trace_scope& operator=(const _trace_scope &) = delete;
+    };
+
+    inline void _trace_emit(); // Writes the record to file descriptor $FIRE_TRACE (default: stderr)
+    inline void _trace_finish(); // Called when fired_main is about to be entered or the parser exits
+
+#define FIRE_TRACE_SCOPE_(phase, name) fire::_trace_scope fire_trace_scope_(phase, name)
+#define FIRE_TRACE_FINISH_() fire::_trace_finish()
+#define FIRE_TRACE_EMIT_() fire::_trace_emit()
+#else
+#define FIRE_TRACE_SCOPE_(phase, name)
+#define FIRE_TRACE_FINISH_()
+#define FIRE_TRACE_EMIT_()
+#endif
+
+    template <typename T>
+    struct _is_string: std::integral_constant<bool, std::is_same<T, std::string>::value ||
+            std::is_same<T, string_view>::value || std::is_same<T, const char *>::value> {};
+
+    template <typename T>
+    class stream;
+    class _parallel_vector;
+
     class arg {
         identifier _id; // No identifier implies vector positional arguments
 
         optional<long long> _int_value;
         optional<long double> _float_value;
         optional<std::string> _string_value;
+        optional<const char *> _literal_value; // Set with _string_value for string literal defaults
+
+        enum : size_t { _min_parallel_chunk = 4096 }; // Smaller chunks aren't worth a thread
+
+        friend class _parallel_vector;
 
         template <typename T>
-        optional<T> _get() { T::unimplemented_function; } // no default function
+        optional<T> _get();
+
+        template <typename T>
+        optional<T> _parse(const string_view &value, const std::string &origin = std::string()); // Origin of fallbacks
+        template <typename T>
+        std::vector<T> _parse_vector(const _arena_vector<string_view> &values);
+        template <typename T> // Only instantiated by _parallel_vector, so programs without it don't need threads
+        std::vector<T> _parse_vector(const _arena_vector<string_view> &values, unsigned requested_threads);
+        template <typename T, typename P>
+        std::vector<T> _convert_vector(const P &parse);
+
+        template <typename T, typename std::enable_if<std::is_integral<T>::value && ! std::is_same<T, bool>::value>::type* = nullptr>
+        optional<T> _get_default() { return _narrow<T>(_int_value); }
+        template <typename T, typename std::enable_if<std::is_floating_point<T>::value>::type* = nullptr>
+        optional<T> _get_default();
+        template <typename T, typename std::enable_if<std::is_same<T, std::string>::value>::type* = nullptr>
+        optional<T> _get_default() { return _string_value; }
+        template <typename T, typename std::enable_if<std::is_same<T, string_view>::value>::type* = nullptr>
+        optional<T> _get_default();
 
         template <typename T, typename std::enable_if<std::is_integral<T>::value && ! std::is_same<T, bool>::value>::type* = nullptr>
-        optional<T> _get_with_precision();
+        optional<T> _narrow(const optional<long long> &opt_value);
         template <typename T, typename std::enable_if<std::is_floating_point<T>::value>::type* = nullptr>
-        optional<T> _get_with_precision();
-        template <typename T, typename std::enable_if<std::is_same<T, bool>::value || std::is_same<T, std::string>::value, bool>::type* = nullptr>
-        optional<T> _get_with_precision() { return _get<T>(); }
+        optional<T> _narrow(const optional<long double> &opt_value);
 
-        template <typename T> optional<T> _convert_optional(bool dec_main_argc=true);
-        template <typename T> T _convert(bool dec_main_argc=true);
-        inline void _log(const std::string &type, bool optional);
+        template <typename T> uint64_t _schema(const char *kind) const; // Declaration and type of a cached value
+        template <typename T> bool _load_cached(const char *kind, T &value, bool dec_main_argc=true);
+        template <typename T> void _store_cached(const char *kind, const T &value);
+
+        template <typename T> optional<T> _convert_optional(const char *type, bool dec_main_argc=true);
+        template <typename T> T _convert(const char *type, bool dec_main_argc=true);
+        inline void _log(const char *type, bool optional);
 
         template <typename T, typename std::enable_if<std::is_integral<T>::value>::type* = nullptr>
         inline void init_default(T value) { _int_value = value; }
         template <typename T, typename std::enable_if<std::is_floating_point<T>::value>::type* = nullptr>
         inline void init_default(T value) { _float_value = value; }
         inline void init_default(const std::string &value) { _string_value = value; }
+        inline void init_default(const char *value) { _string_value = std::string(value); _literal_value = value; }
         inline void init_default(std::nullptr_t) {}
 
         inline arg() = default;
@@ -214,65 +1168,232 @@ namespace fire {
         struct convertible {
             optional<int> _int_value;
             optional<const char *> _char_value;
+            optional<const char *> _env_value;
 
             convertible(int value): _int_value(value) {}
             convertible(const char *value): _char_value(value) {}
+            convertible(env value): _env_value(value.name) {}
         };
 
     public:
         template<typename T=std::nullptr_t>
         inline arg(std::initializer_list<convertible> init, T value=T()) {
-            optional<int> int_value;
-            std::vector<std::string> string_values;
+            std::vector<std::string> string_values, env_names;
+            std::vector<int> positions;
             for(const convertible &val: init) {
                 if(val._int_value.has_value())
-                    int_value = val._int_value.value();
+                    positions.push_back(val._int_value.value());
+                else if(val._env_value.has_value())
+                    env_names.push_back(val._env_value.value());
                 else
                     string_values.push_back(val._char_value.value());
             }
 
-            _id = identifier(string_values, int_value);
+            identifier::_validate(string_values, positions, env_names);
+            _id = identifier(string_values, positions.empty() ? optional<int>() : optional<int>(positions.back()), true);
+            _id.set_env(env_names.empty() ? optional<std::string>() : optional<std::string>(env_names.back()));
             init_default(value);
         }
 
         template<typename T=std::nullptr_t>
-        inline arg(convertible _id, T value=T()):
-            arg({_id}, value) {}
+        inline arg(convertible id_, T value=T()):
+            arg({id_}, value) {}
+
+        template<typename T=std::nullptr_t>
+        inline arg(const _checked_declaration &declaration, T value=T()) {
+            _id = identifier(declaration.names, declaration.pos, true);
+            _id.set_env(declaration.env_name);
+            init_default(value);
+        }
 
         inline static arg vector(std::string _descr = "");
+        inline _parallel_vector parallel(unsigned threads = 0); // Opt-in, for large vector arguments
 
         template <typename T, typename std::enable_if<std::is_integral<T>::value>::type* = nullptr>
-        inline operator optional<T>() { _log("INTEGER", true); return _convert_optional<T>(); }
+        inline operator optional<T>() { return _convert_optional<T>("INTEGER"); }
         template <typename T, typename std::enable_if<std::is_floating_point<T>::value>::type* = nullptr>
-        inline operator optional<T>() { _log("REAL", true); return _convert_optional<T>(); }
-        inline operator optional<std::string>() { _log("STRING", true); return _convert_optional<std::string>(); }
+        inline operator optional<T>() { return _convert_optional<T>("REAL"); }
+        inline operator optional<std::string>() { return _convert_optional<std::string>("STRING"); }
+        inline operator optional<string_view>() { return _convert_optional<string_view>("STRING"); }
 
         template <typename T, typename std::enable_if<std::is_integral<T>::value>::type* = nullptr>
-        inline operator T() { _log("INTEGER", false); return _convert<T>(); }
+        inline operator T() { return _convert<T>("INTEGER"); }
         template <typename T, typename std::enable_if<std::is_floating_point<T>::value>::type* = nullptr>
-        inline operator T() { _log("REAL", false); return _convert<T>(); }
-        inline operator std::string() { _log("STRING", false); return _convert<std::string>(); }
+        inline operator T() { return _convert<T>("REAL"); }
+        inline operator std::string() { return _convert<std::string>("STRING"); }
+        inline operator string_view() { return _convert<string_view>("STRING"); }
         inline operator bool();
 
+        template <typename T>
+        inline operator std::vector<T>();
+        template <typename T>
+        inline operator stream<T>();
+    };
+
+    template <typename T>
+    class stream { // Positional arguments converted on a background thread, ahead of the consumer
+        static_assert((std::is_arithmetic<T>::value && ! std::is_same<T, bool>::value) || std::is_same<T, std::string>::value,
+                      "fire::stream supports integral, floating-point and std::string elements");
+
+        enum : size_t { _chunk_size = 1024, _max_chunks = 16 }; // Bounds memory use of converted values
+
+        struct chunk {
+            std::vector<T> values;
+            std::string error; // Conversion error after the values, ends the stream
+        };
+
+        struct state {
+            const string_view *begin = nullptr, *end = nullptr; // Positional arguments in the matcher's arena
+            std::shared_ptr<_arena> memory; // Keeps the positional arguments alive after fire::release()
+            std::vector<std::shared_ptr<_response_file>> files; // Mapped response files the arguments may point into
+            identifier id;
+            std::mutex mutex;
+            std::condition_variable changed;
+            std::deque<chunk> queue;
+            bool done = false, stop = false;
+            std::thread producer;
+        };
+
+        std::shared_ptr<state> _state; // Null when reading std::cin
+        bool _from_stdin = false; // Source "-" is read by the consumer, no thread is left blocked on std::cin
+        identifier _id;
+        chunk _current;
+        size_t _next = 0;
+
+        inline static void _produce(std::shared_ptr<state> st);
+        inline static bool _push(state &st, chunk &c);
+
+    public:
+        class iterator {
+            stream *_stream = nullptr;
+            T _value = T();
+
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const T *;
+            using reference = const T &;
+
+            iterator() = default;
+            explicit iterator(stream *s): _stream(s) { ++*this; }
+            const T& operator*() const { return _value; }
+            const T* operator->() const { return &_value; }
+            iterator& operator++() { if(! _stream->next(_value)) _stream = nullptr; return *this; }
+            bool operator==(const iterator &other) const { return _stream == other._stream; }
+            bool operator!=(const iterator &other) const { return _stream != other._stream; }
+        };
+
+        inline stream(const string_view *begin, const string_view *end, std::shared_ptr<_arena> memory,
+                      std::vector<std::shared_ptr<_response_file>> files, const identifier &id);
+        stream(stream &&) = default;
+        stream& operator=(stream &&) = delete;
+        inline ~stream();
+
+        inline bool next(T &value);
+        iterator begin() { return iterator(this); }
+        iterator end() { return iterator(); }
+    };
+
+    class _parallel_vector { // Returned by arg::parallel, converts vector positional arguments on several threads
+        arg _arg;
+        unsigned _threads; // 0 for all hardware threads
+
+    public:
+        _parallel_vector(const arg &a, unsigned threads): _arg(a), _threads(threads) {}
+
         template <typename T>
         inline operator std::vector<T>();
     };
 
-    void _instant_assert(bool pass, const std::string &msg, bool programmer_side) {
+    _parallel_vector arg::parallel(unsigned threads) { return _parallel_vector(*this, threads); }
+
+    class parser;
+    using _subcommand_handler = int (*)(parser &, int, const char **, bool); // Generated by FIRE_SUBCOMMANDS(...)
+
+    // Picks the handler named by argv[1] and runs it on the remaining arguments with p
+    inline int _run_subcommand(parser &p, int argc, const char **argv, const _name_table_view &subcommands,
+                               const _subcommand_handler *handlers, bool space_assignment);
+
+    class parser { // Owns its parser state, so separate threads can each parse their own command line
+        _parser_state _state;
+
+        class _activation { // Points fire::arg of this thread at a parser state until destroyed
+            _parser_state *_previous;
+        public:
+            explicit _activation(_parser_state &state): _previous(_::active) { _::active = &state; }
+            _activation(const _activation &) = delete;
+            _activation& operator=(const _activation &) = delete;
+            ~_activation() { _::active = _previous; }
+        };
+
+        void _enable(_feature feature, bool enabled) {
+            _state.features = enabled ? _state.features | feature : _state.features & ~feature;
+        }
+
+        friend int _run_subcommand(parser &, int, const char **, const _name_table_view &, const _subcommand_handler *, bool);
+
+    public:
+        explicit parser(on_error mode = on_error::exit) { _state.mode = mode; }
+
+        // Lets callers pass --fire-cache=FILE, which reads and writes FILE. Off by default, FIRE_CACHE turns it on
+        // for the parsers of FIRE(...) and FIRE_SUBCOMMANDS(...)
+        void enable_cache(bool enabled = true) { _enable(_feature_cache, enabled); }
+
+        // Lets callers pass --fire-config=FILE, which reads argument values from FILE. Off by default, FIRE_CONFIG
+        // turns it on for the parsers of FIRE(...) and FIRE_SUBCOMMANDS(...)
+        void enable_config(bool enabled = true) { _enable(_feature_config, enabled); }
+
+        // Lets callers pass @FILE, which is replaced by the arguments in FILE. Off by default, FIRE_RESPONSE_FILES
+        // turns it on for the parsers of FIRE(...) and FIRE_SUBCOMMANDS(...)
+        void enable_response_files(bool enabled = true) { _enable(_feature_response_files, enabled); }
+
+        // Parses argv for fired_main, then invokes call (usually [] { return fired_main(); }) with this parser active
+        template <typename F, typename C>
+        inline auto run(int argc, const char **argv, F fired_main, const C &call, bool space_assignment = true,
+                        const _name_table_view &declared_names = _name_table_view()) -> decltype(call());
+    };
+
+    // Runs argv through run_with(parser &, argc, argv), or each command line of --fire-batch[=FILE] in turn
+    template <typename F>
+    inline int _run_main(int argc, const char **argv, const F &run_with,
+                         const _name_table_view &options = _name_table_view(),
+                         const _name_table_view &subcommands = _name_table_view(), unsigned features = 0);
+
+    // Candidates for --fire-complete <cword> <words...>, one per line. Served from the name tables without running
+    // fired_main, unless FIRE_NAMES wasn't used and the names have to be read from help
+    template <typename F>
+    inline std::string _complete(int argc, const char **argv, const _name_table_view &options,
+                                 const _name_table_view &subcommands, const F &run_with);
+    inline std::vector<std::string> _help_option_names(const std::string &help);
+    inline std::string _completion_script(const std::string &shell, const char *executable);
+
+    template <typename F, typename>
+    void _instant_assert(bool pass, const F &build_msg, bool programmer_side) {
+        if(! pass)
+            _instant_assert(pass, std::string(build_msg()).c_str(), programmer_side);
+    }
+
+    void _instant_assert(bool pass, const char *msg, bool programmer_side) {
         if (pass)
             return;
 
-        if (!msg.empty()) {
-            std::cerr << "Error";
-            if(programmer_side)
-                std::cerr << " (programmer side)";
-            std::cerr << ": " << msg << std::endl;
-        }
+        std::string output;
+        if (*msg)
+            output = std::string("Error") + (programmer_side ? " (programmer side)" : "") + ": " + msg + "\n";
 
-        exit(_failure_code);
+        _exit_or_throw(_failure_code, output);
     }
 
-    int count_hyphens(const std::string &s) {
+    void _exit_or_throw(int code, const std::string &output) {
+        if(_::current().mode == on_error::throw_exception)
+            throw error(output, code);
+
+        std::cerr << output << std::flush;
+        exit(code);
+    }
+
+    int count_hyphens(const string_view &s) {
         int hyphens;
         for(hyphens = 0; hyphens < (int) s.size() && s[hyphens] == '-'; ++hyphens)
             ;
@@ -286,6 +1407,485 @@ namespace fire {
     }
 
 
+    template <typename T>
+    _conversion _parse_integer(const string_view &s, T &out) {
+        // Decimal integer with optional sign, overflow is detected for the exact width of T
+        using U = typename std::make_unsigned<T>::type;
+        size_t i = 0;
+        while(i < s.size() && isspace((unsigned char) s[i])) // As accepted by std::stoll
+            ++i;
+        bool negative = i < s.size() && s[i] == '-';
+        if(i < s.size() && (s[i] == '-' || s[i] == '+'))
+            ++i;
+        if(i == s.size())
+            return _conversion::invalid;
+
+        U limit = negative ? (U) (U(0) - (U) std::numeric_limits<T>::lowest()) : (U) std::numeric_limits<T>::max();
+        U magnitude = 0;
+        for(; i < s.size(); ++i) {
+            unsigned digit = (unsigned) (unsigned char) s[i] - '0';
+            if(digit > 9)
+                return _conversion::invalid;
+            if(magnitude > (U) ((limit - digit) / 10) || digit > limit)
+                return negative && ! std::numeric_limits<T>::is_signed ? _conversion::negative : _conversion::out_of_range;
+            magnitude = (U) (magnitude * 10 + digit);
+        }
+
+        if(! negative || magnitude == 0)
+            out = (T) magnitude;
+        else
+            out = (T) (-(T) (magnitude - 1) - 1);
+        return _conversion::ok;
+    }
+
+#ifdef FIRE_SIMD_X86_
+    // Token right aligned in 16 lanes as digit values, '0' padded on the left and with the decimal point removed.
+    // Only the bytes of the token are read. Defined for each target, as mixing SSE and AVX encoded instructions stalls
+#define FIRE_SIMD_DIGITS_OF_(name, isa) \
+    __attribute__((target(isa))) \
+    inline __m128i name(_simd_token &token, bool real, bool &candidate) { \
+        __m128i chars; \
+        if(token.length == 16) { \
+            chars = _mm_loadu_si128((const __m128i *) token.begin); \
+        } else { \
+            char buffer[16] = {0}; \
+            std::memcpy(buffer + 16 - token.length, token.begin, token.length); \
+            chars = _mm_loadu_si128((const __m128i *) buffer); \
+        } \
+        const __m128i lane = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15); \
+        __m128i in_token = _mm_cmpgt_epi8(lane, _mm_set1_epi8((char) (15 - token.length))); \
+        chars = _mm_blendv_epi8(_mm_set1_epi8('0'), chars, in_token); \
+        __m128i digits = _mm_sub_epi8(chars, _mm_set1_epi8('0')); \
+        \
+        token.frac_digits = 0; \
+        candidate = true; \
+        int point = real ? _mm_movemask_epi8(_mm_cmpeq_epi8(chars, _mm_set1_epi8('.'))) : 0; \
+        if(point) { /* Lanes up to the point take the digit on their left, lane 0 is zeroed by the shuffle */ \
+            int position = __builtin_ctz((unsigned) point); \
+            candidate = (point & (point - 1)) == 0 && token.length > 1; /* One point and at least one digit */ \
+            token.frac_digits = 15 - position; \
+            __m128i before = _mm_cmpgt_epi8(_mm_set1_epi8((char) (position + 1)), lane); \
+            digits = _mm_shuffle_epi8(digits, _mm_blendv_epi8(lane, _mm_sub_epi8(lane, _mm_set1_epi8(1)), before)); \
+        } \
+        return digits; \
+    }
+
+    FIRE_SIMD_DIGITS_OF_(_simd_digits_of_sse42, "sse4.2")
+    FIRE_SIMD_DIGITS_OF_(_simd_digits_of_avx2, "avx2")
+
+    __attribute__((target("sse4.2")))
+    inline bool _simd_digits_sse42(_simd_token &token, bool real, uint64_t &value) {
+        bool candidate;
+        __m128i d = _simd_digits_of_sse42(token, real, candidate);
+        if(! candidate || _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(d, _mm_set1_epi8(9)), _mm_set1_epi8(9))) != 0xffff)
+            return false;
+        __m128i pairs = _mm_maddubs_epi16(d, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1));
+        __m128i quads = _mm_madd_epi16(pairs, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+        __m128i quads16 = _mm_packus_epi32(quads, quads);
+        __m128i octs = _mm_madd_epi16(quads16, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+        value = (uint64_t) (uint32_t) _mm_cvtsi128_si32(octs) * 100000000 + (uint32_t) _mm_extract_epi32(octs, 1);
+        return true;
+    }
+
+    __attribute__((target("avx2")))
+    inline unsigned _simd_digits_avx2(_simd_token tokens[2], bool real, uint64_t values[2]) { // Bit i is set if token i is valid
+        bool candidate[2];
+        __m128i low = _simd_digits_of_avx2(tokens[0], real, candidate[0]);
+        __m128i high = _simd_digits_of_avx2(tokens[1], real, candidate[1]);
+        __m256i d = _mm256_set_m128i(high, low); // One token per 128-bit lane, the arithmetic below stays within lanes
+        unsigned valid = (unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(d, _mm256_set1_epi8(9)), _mm256_set1_epi8(9)));
+        __m256i pairs = _mm256_maddubs_epi16(d, _mm256_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1,
+                                                                 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1));
+        __m256i quads = _mm256_madd_epi16(pairs, _mm256_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1, 100, 1, 100, 1, 100, 1, 100, 1));
+        __m256i quads16 = _mm256_packus_epi32(quads, quads);
+        __m256i octs = _mm256_madd_epi16(quads16, _mm256_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1,
+                                                                    10000, 1, 10000, 1, 10000, 1, 10000, 1));
+        values[0] = (uint64_t) (uint32_t) _mm256_extract_epi32(octs, 0) * 100000000 + (uint32_t) _mm256_extract_epi32(octs, 1);
+        values[1] = (uint64_t) (uint32_t) _mm256_extract_epi32(octs, 4) * 100000000 + (uint32_t) _mm256_extract_epi32(octs, 5);
+        return (candidate[0] && (valid & 0xffff) == 0xffff ? 1u : 0u) | (candidate[1] && (valid >> 16) == 0xffff ? 2u : 0u);
+    }
+#endif
+
+    int _simd_level() {
+#ifdef FIRE_SIMD_X86_
+        static const int level = [] {
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") ? 2 : __builtin_cpu_supports("sse4.2") ? 1 : 0;
+        }();
+        return level;
+#else
+        return 0;
+#endif
+    }
+
+    bool _simd_prepare(const string_view &s, bool real, _simd_token &token) {
+        // Kernels accept [+-]digits, or [+-][digits].[digits][e[+-]digits] with up to 3 exponent digits for reals.
+        // Anything else is left to the scalar parser
+        size_t sign = s.size() > 0 && (s[0] == '-' || s[0] == '+');
+        token.negative = sign && s[0] == '-';
+        token.begin = s.data() + sign;
+        token.length = s.size() - sign;
+        token.exponent = 0;
+        for(size_t k = 2; real && k <= 5 && k <= token.length; ++k) {
+            char c = token.begin[token.length - k];
+            if(c != 'e' && c != 'E')
+                continue;
+            const char *exp = token.begin + token.length - k + 1, *exp_end = token.begin + token.length;
+            bool exp_negative = *exp == '-';
+            exp += *exp == '-' || *exp == '+';
+            if(exp == exp_end)
+                return false;
+            for(; exp < exp_end; ++exp) {
+                if(*exp < '0' || *exp > '9')
+                    return false;
+                token.exponent = token.exponent * 10 + (*exp - '0');
+            }
+            token.exponent = exp_negative ? -token.exponent : token.exponent;
+            token.length -= k;
+            break;
+        }
+        return token.length >= 1 && token.length <= 16;
+    }
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value>::type* = nullptr>
+    inline bool _simd_finish(const _simd_token &token, uint64_t magnitude, T &out) { // Same result as _parse_integer
+        using U = typename std::make_unsigned<T>::type;
+        U limit = token.negative ? (U) (U(0) - (U) std::numeric_limits<T>::lowest()) : (U) std::numeric_limits<T>::max();
+        if(magnitude > (uint64_t) limit)
+            return false; // Out of range, reported by the scalar parser
+        if(! token.negative || magnitude == 0)
+            out = (T) magnitude;
+        else
+            out = (T) (-(T) (magnitude - 1) - 1);
+        return true;
+    }
+
+    template <typename T, typename std::enable_if<std::is_floating_point<T>::value>::type* = nullptr>
+    inline bool _simd_finish(const _simd_token &token, uint64_t mantissa, T &out) { // Same result as _parse_real
+        // Exact mantissa and power of ten round correctly in one operation, as in the fast path of _parse_real
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+        static const T pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+        const int max_exact_pow10 = std::numeric_limits<T>::digits * 4306 / 10000; // At most 22, for double
+        int exponent = token.exponent - token.frac_digits;
+        if((mantissa >> std::numeric_limits<T>::digits) != 0 || exponent < -max_exact_pow10 || exponent > max_exact_pow10)
+            return false;
+        T value = exponent >= 0 ? (T) mantissa * pow10[exponent] : (T) mantissa / pow10[-exponent];
+        out = token.negative ? -value : value;
+        return true;
+#else
+        (void) token; (void) mantissa; (void) out;
+        return false;
+#endif
+    }
+
+    template <typename T>
+    inline size_t _parse_range(const string_view *values, size_t count, T *out, _conversion &result, std::false_type) {
+        for(size_t i = 0; i < count; ++i) {
+            result = _parse_value(values[i], out[i]);
+            if(result != _conversion::ok)
+                return i;
+        }
+        return count;
+    }
+
+    template <typename T>
+    inline size_t _parse_range(const string_view *values, size_t count, T *out, _conversion &result, std::true_type) {
+        int level = _simd_level();
+        if(level == 0)
+            return _parse_range(values, count, out, result, std::false_type());
+
+        const bool real = std::is_floating_point<T>::value;
+        _simd_token tokens[2];
+        size_t pending[2]; // Indices of prepared tokens
+        size_t n_pending = 0;
+        auto scalar = [&](size_t i) {
+            result = _parse_value(values[i], out[i]);
+            return result == _conversion::ok;
+        };
+        auto flush = [&]() { // Converts prepared tokens, or leaves them to the scalar parser
+            uint64_t converted[2] = {0, 0};
+            unsigned valid = 0;
+#ifdef FIRE_SIMD_X86_
+            if(n_pending == 2 && level >= 2)
+                valid = _simd_digits_avx2(tokens, real, converted);
+            else
+                for(size_t k = 0; k < n_pending; ++k)
+                    valid |= _simd_digits_sse42(tokens[k], real, converted[k]) ? 1u << k : 0;
+#endif
+            size_t failed = count;
+            for(size_t k = 0; k < n_pending && failed == count; ++k)
+                if(! ((valid >> k) & 1 && _simd_finish(tokens[k], converted[k], out[pending[k]])) && ! scalar(pending[k]))
+                    failed = pending[k];
+            n_pending = 0;
+            return failed;
+        };
+
+        for(size_t i = 0; i < count; ++i) {
+            if(! _simd_prepare(values[i], real, tokens[n_pending])) {
+                size_t failed = flush(); // Keeps failures in order
+                if(failed != count)
+                    return failed;
+                if(! scalar(i))
+                    return i;
+                continue;
+            }
+            pending[n_pending++] = i;
+            if(n_pending == 2) {
+                size_t failed = flush();
+                if(failed != count)
+                    return failed;
+            }
+        }
+        size_t failed = flush();
+        if(failed == count)
+            result = _conversion::ok;
+        return failed;
+    }
+
+    template <typename T>
+    size_t _parse_range(const string_view *values, size_t count, T *out, _conversion &result) {
+        return _parse_range(values, count, out, result, _simd_convertible<T>());
+    }
+
+    void _bigint::mul_add(uint32_t mul, uint32_t add) {
+        uint64_t carry = add;
+        for(uint32_t &limb: _limbs) {
+            carry += (uint64_t) limb * mul;
+            limb = (uint32_t) carry;
+            carry >>= 32;
+        }
+        if(carry)
+            _limbs.push_back((uint32_t) carry);
+        _trim();
+    }
+
+    void _bigint::mul_pow10(long long exp) {
+        static const uint32_t pow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+        for(; exp >= 9; exp -= 9)
+            mul_add(1000000000, 0);
+        mul_add(pow10[exp], 0);
+    }
+
+    void _bigint::shift_left(size_t bits) {
+        if(_limbs.empty())
+            return;
+        size_t rem = bits % 32;
+        if(rem) {
+            uint32_t carry = 0;
+            for(uint32_t &limb: _limbs) {
+                uint32_t next = limb >> (32 - rem);
+                limb = (limb << rem) | carry;
+                carry = next;
+            }
+            if(carry)
+                _limbs.push_back(carry);
+        }
+        _limbs.insert(_limbs.begin(), bits / 32, 0);
+    }
+
+    void _bigint::shift_right_one() {
+        for(size_t i = 0; i < _limbs.size(); ++i)
+            _limbs[i] = (_limbs[i] >> 1) | (i + 1 < _limbs.size() ? _limbs[i + 1] << 31 : 0);
+        _trim();
+    }
+
+    void _bigint::subtract(const _bigint &other) { // Requires *this >= other
+        int64_t borrow = 0;
+        for(size_t i = 0; i < _limbs.size(); ++i) {
+            int64_t diff = (int64_t) _limbs[i] - borrow - (i < other._limbs.size() ? (int64_t) other._limbs[i] : 0);
+            borrow = diff < 0;
+            _limbs[i] = (uint32_t) (diff + (borrow << 32));
+        }
+        _trim();
+    }
+
+    size_t _bigint::bit_length() const {
+        if(_limbs.empty())
+            return 0;
+        size_t bits = 32 * (_limbs.size() - 1);
+        for(uint32_t top = _limbs.back(); top; top >>= 1)
+            ++bits;
+        return bits;
+    }
+
+    int _bigint::compare(const _bigint &a, const _bigint &b) {
+        if(a._limbs.size() != b._limbs.size())
+            return a._limbs.size() < b._limbs.size() ? -1 : 1;
+        for(size_t i = a._limbs.size(); i-- > 0;)
+            if(a._limbs[i] != b._limbs[i])
+                return a._limbs[i] < b._limbs[i] ? -1 : 1;
+        return 0;
+    }
+
+    template <typename T>
+    _conversion _parse_real(const string_view &s, T &out) {
+        // Locale independent decimal real number ([+-]digits[.digits][e[+-]digits]), correctly rounded to T
+        auto is_digit = [](char c) { return c >= '0' && c <= '9'; };
+        size_t i = 0;
+        while(i < s.size() && isspace((unsigned char) s[i])) // As accepted by std::stold
+            ++i;
+        bool negative = i < s.size() && s[i] == '-';
+        if(i < s.size() && (s[i] == '-' || s[i] == '+'))
+            ++i;
+
+        size_t mantissa_begin = i;
+        long long digit_count = 0, frac_digits = 0;
+        bool seen_point = false;
+        for(; i < s.size(); ++i) {
+            if(is_digit(s[i])) {
+                ++digit_count;
+                frac_digits += seen_point;
+            } else if(s[i] == '.' && ! seen_point)
+                seen_point = true;
+            else
+                break;
+        }
+        size_t mantissa_end = i;
+        if(digit_count == 0)
+            return _conversion::invalid;
+
+        long long exponent = 0;
+        if(i < s.size() && (s[i] == 'e' || s[i] == 'E')) {
+            ++i;
+            bool exp_negative = i < s.size() && s[i] == '-';
+            if(i < s.size() && (s[i] == '-' || s[i] == '+'))
+                ++i;
+            size_t exp_begin = i;
+            for(; i < s.size() && is_digit(s[i]); ++i)
+                if(exponent < 1000000000) // Far beyond any representable value, but can't overflow
+                    exponent = exponent * 10 + (s[i] - '0');
+            if(i == exp_begin)
+                return _conversion::invalid;
+            if(exp_negative)
+                exponent = -exponent;
+        }
+        if(i != s.size())
+            return _conversion::invalid;
+
+        // The value is (n significant digits) * 10^exponent, trailing zeros are moved to exponent
+        long long n = 0, zero_run = 0;
+        uint64_t leading = 0; // First 19 significant digits
+        for(size_t j = mantissa_begin; j < mantissa_end; ++j) {
+            if(! is_digit(s[j]) || (n == 0 && s[j] == '0'))
+                continue;
+            if(n < 19)
+                leading = leading * 10 + (uint64_t) (s[j] - '0');
+            ++n;
+            zero_run = s[j] == '0' ? zero_run + 1 : 0;
+        }
+        for(long long j = n - zero_run; j < std::min(n, 19LL); ++j) // Drop trailing zeros from leading digits
+            leading /= 10;
+        n -= zero_run;
+        exponent += zero_run - frac_digits;
+
+        const int p = std::numeric_limits<T>::digits;
+        long long magnitude = n + exponent; // Value lies in [10^(magnitude - 1), 10^magnitude)
+        if(n == 0 || magnitude < std::numeric_limits<T>::min_exponent10 - std::numeric_limits<T>::digits10 - 3) {
+            out = negative ? -T(0) : T(0);
+            return _conversion::ok;
+        }
+        if(magnitude - 1 > std::numeric_limits<T>::max_exponent10)
+            return _conversion::out_of_range;
+
+        // Fast path: both the significand and the power of ten are exact in T, so one operation rounds correctly
+        bool exact_arithmetic = std::is_same<T, long double>::value;
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+        exact_arithmetic = true;
+#endif
+        const long long max_exact_pow10 = p * 4306LL / 10000; // Largest k with 5^k < 2^p
+        if(exact_arithmetic && n <= 19 && (p >= 64 || (leading >> (p % 64)) == 0) &&
+                -max_exact_pow10 <= exponent && exponent <= max_exact_pow10 && max_exact_pow10 <= 27) {
+            static const long double pow10[] = {1e0L, 1e1L, 1e2L, 1e3L, 1e4L, 1e5L, 1e6L, 1e7L, 1e8L, 1e9L,
+                1e10L, 1e11L, 1e12L, 1e13L, 1e14L, 1e15L, 1e16L, 1e17L, 1e18L, 1e19L, 1e20L,
+                1e21L, 1e22L, 1e23L, 1e24L, 1e25L, 1e26L, 1e27L};
+            T value = (T) leading;
+            if(exponent >= 0)
+                value *= (T) pow10[exponent];
+            else
+                value /= (T) pow10[-exponent];
+            out = negative ? -value : value;
+            return _conversion::ok;
+        }
+
+        if(p > 64) { // Wider than the 64-bit quotient below, defer to the C library
+            std::string copy = s.str();
+            out = (T) std::strtold(copy.c_str(), nullptr);
+            if(std::isinf(out))
+                return _conversion::out_of_range;
+            return _conversion::ok;
+        }
+
+        // Slow path: exact division of big integers. 800 digits are enough to decide any rounding,
+        // remaining nonzero digits are represented by an extra 1 digit
+        const long long max_digits = 800;
+        _bigint num, den(1);
+        long long kept = 0;
+        bool truncated = false;
+        for(size_t j = mantissa_begin; j < mantissa_end && kept < n; ++j) {
+            if(! is_digit(s[j]) || (kept == 0 && s[j] == '0'))
+                continue;
+            if(kept < max_digits)
+                num.mul_add(10, (uint32_t) (s[j] - '0'));
+            else
+                truncated |= s[j] != '0';
+            ++kept;
+        }
+        exponent += n - std::min(n, max_digits);
+        if(truncated) {
+            num.mul_add(10, 1);
+            --exponent;
+        }
+        if(exponent >= 0)
+            num.mul_pow10(exponent);
+        else
+            den.mul_pow10(-exponent);
+
+        // Find q = floor(num / (den * 2^b)) with p bits, or fewer for subnormals
+        const long long b_min = std::numeric_limits<T>::min_exponent - p;
+        uint64_t q = 0;
+        _bigint rem, divisor;
+        auto divide = [&](long long b) {
+            rem = num;
+            divisor = den;
+            if(b < 0) rem.shift_left((size_t) -b);
+            else divisor.shift_left((size_t) b);
+
+            _bigint shifted = divisor;
+            shifted.shift_left(p - 1);
+            q = 0;
+            for(int k = p - 1; k >= 0; --k) {
+                if(_bigint::compare(rem, shifted) >= 0) {
+                    rem.subtract(shifted);
+                    q |= uint64_t(1) << k;
+                }
+                shifted.shift_right_one();
+            }
+        };
+        long long b = std::max((long long) num.bit_length() - (long long) den.bit_length() - p + 1, b_min);
+        divide(b);
+        if(q < (uint64_t(1) << (p - 1)) && b > b_min)
+            divide(--b);
+
+        // Round half to even
+        rem.shift_left(1);
+        int cmp = _bigint::compare(rem, divisor);
+        if(cmp > 0 || (cmp == 0 && (q & 1))) {
+            ++q;
+            if(q == (p < 64 ? uint64_t(1) << (p % 64) : 0)) {
+                q = uint64_t(1) << (p - 1);
+                ++b;
+            }
+        }
+
+        T value = std::ldexp((T) q, (int) b);
+        if(std::isinf(value))
+            return _conversion::out_of_range;
+        out = negative ? -value : value;
+        return _conversion::ok;
+    }
+
+
     std::string identifier::prepend_hyphens(const std::string &name) {
         if(name.size() == 1)
             return "-" + name;
@@ -294,17 +1894,59 @@ namespace fire {
         return name;
     }
 
-    void identifier::_check_name(const std::string &name) {
-        _instant_assert(count_hyphens(name) == 0, "argument " + name +
-        " has hyphens prefixed in declaration");
-        _instant_assert(name.size() >= 1, "name must contain at least one character");
-        _instant_assert(name.size() >= 2 || !isdigit(name[0]), "single character name must not be a digit (" + name + ")");
-    }
-
     inline identifier::identifier(optional<std::string> descr):
         _descr(descr), _vector(true), _help("..."), _longer("...") {}
 
-    inline identifier::identifier(const std::vector<std::string> &names, optional<int> pos) {
+    void identifier::_validate(const std::vector<std::string> &names, const std::vector<int> &positions,
+                               const std::vector<std::string> &envs) {
+        // Same rules as FIRE_ID(...), the message is followed by the entries breaking them
+        _declaration_state st{0, 0, 0, 0, 0, 0, _declaration_error::none};
+        std::string first_name[3], pos_name, name_given; // First entry of each hyphen count
+        for(const std::string &name: names) {
+            st = _declaration_name(st, name.data(), name.size());
+            int hyphens = _entry_hyphens(name.data(), name.size());
+            bool twice = st.error == _declaration_error::descr_twice || st.error == _declaration_error::short_twice ||
+                         st.error == _declaration_error::long_twice;
+            _instant_assert(st.error == _declaration_error::none, [&] {
+                return std::string(_declaration_message(st.error)) + ": " + (twice ? first_name[hyphens] + " and " : "") + name;
+            });
+            if(_entry_is_pos_name(name.data(), name.size()))
+                pos_name = name;
+            else if(first_name[hyphens].empty())
+                first_name[hyphens] = name;
+            if(hyphens > 0 && name_given.empty())
+                name_given = name;
+        }
+        for(int position: positions) {
+            st = _declaration_index(st);
+            _instant_assert(st.error == _declaration_error::none, [&] {
+                return std::string(_declaration_message(st.error)) + ": " + std::to_string(positions[0]) + " and " +
+                       std::to_string(position);
+            });
+        }
+        for(const std::string &env_name: envs) {
+            st = _declaration_env(st);
+            _instant_assert(st.error == _declaration_error::none, [&] {
+                return std::string(_declaration_message(st.error)) + ": " + envs[0] + " and " + env_name;
+            });
+        }
+
+        st = _declaration_finish(st);
+        _instant_assert(st.error == _declaration_error::none, [&] {
+            std::string message = _declaration_message(st.error);
+            if(st.error == _declaration_error::name_and_index)
+                return message + ": " + name_given + " and " + std::to_string(positions[0]);
+            if(st.error == _declaration_error::pos_name_without_index)
+                return message + ": " + pos_name;
+            return message;
+        });
+    }
+
+    inline identifier::identifier(const std::vector<std::string> &names, optional<int> pos, bool validated) {
+        if(! validated) // FIRE_ID(...) declarations are validated at compile time
+            _validate(names, pos.has_value() ? std::vector<int>(1, pos.value()) : std::vector<int>(),
+                      std::vector<std::string>());
+
         // Find description, shorthand and long name
         for(const std::string &name: names) {
             if(name.size() >= 2 && name.front() == '<' && name.back() == '>') {
@@ -313,29 +1955,12 @@ namespace fire {
             }
 
             int hyphens = count_hyphens(name);
-            _instant_assert(hyphens <= 2, "Identifier entry " + name + " must prefix either:"
-                                          " 0 hyphens for description,"
-                                          " 1 hyphen for short-hand name"
-                                          " 2 hyphens for long name");
-            if(hyphens == 0) {
-                _instant_assert(! _descr.has_value(),
-                        "Can't specify descriptions twice: " + _descr.value_or("") + " and " + name);
+            if(hyphens == 0)
                 _descr = name;
-            } else if(hyphens == 1) {
-                _instant_assert(! _short_name.has_value(),
-                        "Can't specify shorthands twice: " + _short_name.value_or("") + " and " + name);
-                _instant_assert(name.size() == 2,
-                        "Single hyphen shorthand " + name + " must be one character");
-                _instant_assert(! isdigit(name[1]),
-                        "Argument " + name + " can't start with a number");
+            else if(hyphens == 1)
                 _short_name = name;
-            } else if(hyphens == 2) {
-                _instant_assert(! _long_name.has_value(),
-                        "Can't specify long names twice: " + _long_name.value_or("") + " and " + name);
-                _instant_assert(name.size() >= 4,
-                                "Two hyphen name " + name + " must have at least two characters");
+            else if(hyphens == 2)
                 _long_name = name;
-            }
         }
 
         // Set help and longer variant
@@ -349,22 +1974,12 @@ namespace fire {
 
         // Set position
         if(pos.has_value()) {
-            _instant_assert(! _short_name.has_value(),
-                    "Can't specify both name " + _short_name.value_or("") + " and index " + std::to_string(pos.value()));
-            _instant_assert(! _long_name.has_value(),
-                    "Can't specify both name " + _long_name.value_or("") + " and index " + std::to_string(pos.value()));
             _pos = pos;
             if(_pos_name.has_value())
                 _longer = _help = _pos_name.value();
             else
                 _longer = _help = "<" + std::to_string(pos.value()) + ">";
         }
-        _instant_assert(_short_name.has_value() || _long_name.has_value() || _pos.has_value(),
-                "Argument must be specified with at least on of the following: shorthand, long name or index");
-
-        if(_pos_name.has_value())
-            _instant_assert(_pos.has_value(),
-                    "Positional name " + _pos_name.value_or("") + " requires the argument to be positional");
     }
 
     bool identifier::operator<(const identifier &other) const {
@@ -409,6 +2024,18 @@ namespace fire {
     }
 
 
+    template <typename T>
+    std::string _conversion_error(_conversion result, const string_view &value, const identifier &id) {
+        switch(result) {
+            case _conversion::ok: return "";
+            case _conversion::negative: return "argument " + id.help() + " must be positive";
+            case _conversion::out_of_range: return "value " + value + " out of range";
+            case _conversion::invalid: break;
+        }
+        return "value " + value + (std::is_floating_point<T>::value ? " is not a real number" : " is not an integer");
+    }
+
+
     template<typename ORDER, typename VALUE>
     void _first<ORDER, VALUE>::set(const ORDER &order, const VALUE &value) {
         if(_empty || order < _order) {
@@ -424,84 +2051,576 @@ namespace fire {
     }
 
 
-    _matcher::_matcher(int argc, const char **argv, int main_argc, bool space_assignment, bool strict) {
+    void* _arena::allocate(size_t size, size_t alignment) {
+        size_t padding = (alignment - (size_t) ((uintptr_t) _next % alignment)) % alignment;
+        if(padding + size > _left) {
+            _block_size = std::max(_block_size * 2, size + alignment);
+            _blocks.emplace_back(new char[_block_size]);
+            _next = _blocks.back().get();
+            _left = _block_size;
+            padding = (alignment - (size_t) ((uintptr_t) _next % alignment)) % alignment;
+        }
+        void *p = _next + padding;
+        _next += padding + size;
+        _left -= padding + size;
+        return p;
+    }
+
+    string_view _arena::copy(const string_view &s) {
+        char *data = static_cast<char *>(allocate(s.size() + 1, 1));
+        std::copy(s.begin(), s.end(), data);
+        data[s.size()] = '\0';
+        return string_view(data, s.size());
+    }
+
+    _mapped_file::_mapped_file(const char *path) {
+#ifdef FIRE_POSIX_
+        int fd = open(path, O_RDONLY);
+        if(fd < 0)
+            return;
+        struct stat st;
+        if(fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+            _size = (size_t) st.st_size;
+            _open = _size == 0;
+            if(_size > 0) {
+                // Read-only, so the file isn't copied into private memory by writes
+                void *data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if(data != MAP_FAILED) {
+                    _data = (char *) data;
+                    _open = _mapped = true;
+                }
+            }
+        }
+        close(fd);
+#else
+        FILE *file = std::fopen(path, "rb");
+        if(file == nullptr)
+            return;
+        char chunk[1 << 16];
+        for(size_t n; (n = std::fread(chunk, 1, sizeof(chunk), file)) > 0;)
+            _buffer.insert(_buffer.end(), chunk, chunk + n);
+        bool failed = std::ferror(file) != 0;
+        std::fclose(file);
+        if(failed)
+            return;
+        _size = _buffer.size();
+        _data = _buffer.data();
+        _open = true;
+#endif
+    }
+
+    _mapped_file::~_mapped_file() {
+#ifdef FIRE_POSIX_
+        if(_mapped)
+            munmap(_data, _size);
+#endif
+    }
+
+    void _response_file::tokenize(_arena_vector<string_view> &tokens) {
+        _tokenize(_file.data(), _file.size(), _copies, tokens);
+    }
+
+    _config_file::_config_file(const char *path): _file(path), _path(path) {
+        if(_file.is_open())
+            _index_lines();
+    }
+
+    void _config_file::_index_lines() { // Single pass over the file, nothing but keys within sections is copied
+        auto is_blank = [](char c) { return c == ' ' || c == '\t' || c == '\r'; };
+        const char *data = _file.data(), *end = data + _file.size();
+        if(_file.size() >= UINT32_MAX) { // Sizes and entry indices are 32 bit
+            _error = _path + ": file is larger than 4 GB";
+            return;
+        }
+        std::string section;
+        size_t line = 0;
+        for(const char *next = data; next < end;) {
+            ++line;
+            const char *begin = next, *eol = (const char *) memchr(next, '\n', (size_t) (end - next));
+            eol = eol ? eol : end;
+            next = eol + (eol < end);
+
+            const char *last = eol;
+            while(begin < last && is_blank(*begin)) ++begin;
+            while(begin < last && is_blank(last[-1])) --last;
+            if(begin == last || *begin == '#' || *begin == ';')
+                continue;
+
+            if(*begin == '[') {
+                if(last[-1] != ']' || last - begin < 3) {
+                    _error = _path + ":" + std::to_string(line) + ": expected [section]";
+                    return;
+                }
+                section.assign(begin + 1, last - 1);
+                continue;
+            }
+
+            const char *equals = (const char *) memchr(begin, '=', (size_t) (last - begin));
+            const char *key_end = equals, *value = equals ? equals + 1 : nullptr;
+            while(equals && key_end > begin && is_blank(key_end[-1])) --key_end;
+            if(! equals || key_end == begin) {
+                _error = _path + ":" + std::to_string(line) + ": expected key = value";
+                return;
+            }
+            while(value < last && is_blank(*value)) ++value;
+            if(last - value >= 2 && (*value == '"' || *value == '\'') && last[-1] == *value) { // Quotes keep blanks
+                ++value;
+                --last;
+            }
+
+            string_view key(begin, (size_t) (key_end - begin));
+            if(! section.empty()) {
+                char *copy = static_cast<char *>(_strings.allocate(section.size() + 1 + key.size(), 1));
+                std::copy(section.begin(), section.end(), copy);
+                copy[section.size()] = '.';
+                std::copy(key.begin(), key.end(), copy + section.size() + 1);
+                key = string_view(copy, section.size() + 1 + key.size());
+            }
+            _insert(key, value, (size_t) (last - value));
+        }
+    }
+
+    uint32_t& _config_file::_find_slot(const string_view &key, uint32_t hash) { // Linear probing, never full
+        size_t mask = _slots.size() - 1;
+        for(size_t i = hash & mask;; i = (i + 1) & mask)
+            if(_slots[i] == 0 || (_entries[_slots[i] - 1].hash == hash && _entries[_slots[i] - 1].key == key))
+                return _slots[i];
+    }
+
+    void _config_file::_insert(const string_view &key, const char *value, size_t size) {
+        uint32_t hash = (uint32_t) _string_view_hash()(key);
+        if(2 * (_entries.size() + 1) > _slots.size()) { // Keep load factor at most 1/2
+            _slots.assign(std::max<size_t>(16, 2 * _slots.size()), 0);
+            for(size_t i = 0; i < _entries.size(); ++i)
+                _find_slot(_entries[i].key, _entries[i].hash) = (uint32_t) (i + 1);
+        }
+
+        uint32_t &slot = _find_slot(key, hash);
+        if(slot != 0) { // Later definitions take precedence
+            _entries[slot - 1].value = value;
+            _entries[slot - 1].size = (uint32_t) size;
+            return;
+        }
+        _entries.push_back({key, value, (uint32_t) size, hash, false});
+        slot = (uint32_t) _entries.size();
+    }
+
+    optional<string_view> _config_file::get(const string_view &key) {
+        if(_slots.empty())
+            return {};
+        uint32_t slot = _find_slot(key, (uint32_t) _string_view_hash()(key));
+        if(slot == 0)
+            return {};
+
+        _entry &entry = _entries[slot - 1];
+        if(! entry.terminated) {
+            entry.value = _strings.copy(string_view(entry.value, entry.size)).data();
+            entry.terminated = true;
+        }
+        return string_view(entry.value, entry.size);
+    }
+
+    bool _argument_cache::_stamp(const std::string &path, _file_stamp &stamp) {
+#ifdef FIRE_POSIX_
+        struct stat st;
+        if(stat(path.c_str(), &st) != 0)
+            return false;
+        stamp.path = path;
+        stamp.size = (uint64_t) st.st_size;
+        stamp.seconds = (int64_t) st.st_mtime;
+#ifdef __APPLE__
+        stamp.nanoseconds = (int64_t) st.st_mtimespec.tv_nsec;
+#else
+        stamp.nanoseconds = (int64_t) st.st_mtim.tv_nsec;
+#endif
+        return true;
+#else
+        (void) path;
+        (void) stamp;
+        return false; // Without modification times, runs reading files aren't cached
+#endif
+    }
+
+    bool _argument_cache::load(const _environment_map &environment) {
+        _file.reset(new _mapped_file(_path.c_str()));
+        _next = _file->data();
+        _end = _next + _file->size();
+
+        const char magic[8] = {'F', 'I', 'R', 'E', 'C', 'C', 'H', '1'};
+        uint64_t key = 0, n_files = 0, n_env = 0;
+        bool valid = _file->is_open() && _file->size() >= sizeof(magic) && std::memcmp(_next, magic, sizeof(magic)) == 0;
+        _next += valid ? sizeof(magic) : 0;
+        valid = valid && _get(key) && key == _key && _get(n_files);
+        for(uint64_t i = 0; valid && i < n_files; ++i) {
+            _file_stamp cached, current;
+            valid = _get(cached.path) && _get(cached.seconds) && _get(cached.nanoseconds) && _get(cached.size) &&
+                    _stamp(cached.path, current) && cached.seconds == current.seconds &&
+                    cached.nanoseconds == current.nanoseconds && cached.size == current.size;
+        }
+        valid = valid && _get(n_env);
+        for(uint64_t i = 0; valid && i < n_env; ++i) {
+            _env_stamp stamp;
+            valid = _get(stamp.name) && _get(stamp.present) && _get(stamp.hash);
+            auto it = environment.find(stamp.name);
+            valid = valid && stamp.present == (it != environment.end()) &&
+                    (! stamp.present || stamp.hash == (uint64_t) _string_view_hash()(it->second));
+            if(valid)
+                _env.push_back(stamp);
+        }
+
+        _hit = valid;
+        _entries = _next;
+        if(! _hit) {
+            _env.clear();
+            _file.reset();
+            _entries = _next = _end = nullptr;
+        }
+        return _hit;
+    }
+
+    void _argument_cache::recover() {
+        _hit = false;
+        _record.assign(_entries, _next); // Environment stamps are kept, files are stamped again while parsing
+    }
+
+    void _argument_cache::add_file(const std::string &path) {
+        if(_hit)
+            return;
+        _file_stamp stamp;
+        if(_stamp(path, stamp))
+            _files.push_back(stamp);
+        else
+            _recordable = false;
+    }
+
+    void _argument_cache::add_env(const std::string &name, const optional<string_view> &value) {
+        if(! _hit)
+            _env.push_back({name, (uint8_t) value.has_value(), value.has_value() ? (uint64_t) _string_view_hash()(*value) : 0});
+    }
+
+    void _argument_cache::save() {
+        if(_hit || ! _recordable || _saved)
+            return;
+        _saved = true;
+
+        std::string values = std::move(_record);
+        _record.assign("FIRECCH1", 8);
+        _put(_key);
+        _put((uint64_t) _files.size());
+        for(const _file_stamp &stamp: _files) {
+            _put(stamp.path);
+            _put(stamp.seconds);
+            _put(stamp.nanoseconds);
+            _put(stamp.size);
+        }
+        _put((uint64_t) _env.size());
+        for(const _env_stamp &stamp: _env) {
+            _put(stamp.name);
+            _put(stamp.present);
+            _put(stamp.hash);
+        }
+
+        // Renamed over the cache, so concurrent runs never read a partially written file
+        std::string temporary = _path + ".tmp";
+#ifdef FIRE_POSIX_
+        temporary += std::to_string((long long) getpid());
+#endif
+        bool written;
+        {
+            std::ofstream out(temporary, std::ios::binary);
+            out.write(_record.data(), (std::streamsize) _record.size());
+            out.write(values.data(), (std::streamsize) values.size());
+            written = (bool) out;
+        }
+#ifndef FIRE_POSIX_
+        std::remove(_path.c_str()); // Renaming doesn't replace files elsewhere
+#endif
+        if(! written || std::rename(temporary.c_str(), _path.c_str()) != 0)
+            std::remove(temporary.c_str());
+    }
+
+    void _tokenize(const char *data, size_t size, _arena &copies, _arena_vector<string_view> &tokens,
+                   bool backslash_escapes) {
+        // Whitespace separates tokens, quotes group them and backslash escapes the next character (or only '"')
+        size_t i = 0;
+        while(true) {
+            while(i < size && isspace((unsigned char) data[i]))
+                ++i;
+            if(i >= size)
+                break;
+
+            size_t begin = i;
+            bool plain = true;
+            char quote = 0;
+            for(; i < size; ++i) {
+                char c = data[i];
+                if(c == '\\' && quote != '\'' && i + 1 < size && (backslash_escapes || data[i + 1] == '"')) {
+                    plain = false;
+                    ++i;
+                } else if(quote != 0 && c == quote) {
+                    quote = 0;
+                } else if(quote == 0 && (c == '"' || c == '\'')) {
+                    plain = false;
+                    quote = c;
+                } else if(quote == 0 && isspace((unsigned char) c)) {
+                    break;
+                }
+            }
+            if(plain) {
+                tokens.emplace_back(data + begin, i - begin);
+                continue;
+            }
+
+            char *copy = static_cast<char *>(copies.allocate(i - begin + 1, 1)), *write = copy;
+            quote = 0;
+            for(size_t j = begin; j < i; ++j) { // Same rules as above, within the token
+                char c = data[j];
+                if(c == '\\' && quote != '\'' && j + 1 < size && (backslash_escapes || data[j + 1] == '"'))
+                    *write++ = data[++j];
+                else if(quote != 0 && c == quote)
+                    quote = 0;
+                else if(quote == 0 && (c == '"' || c == '\''))
+                    quote = c;
+                else
+                    *write++ = c;
+            }
+            *write = '\0';
+            tokens.emplace_back(copy, (size_t) (write - copy));
+        }
+    }
+
+
+    _matcher::_matcher(int argc, const char **argv, int main_argc, bool space_assignment, bool strict,
+                       const _name_table_view &declared_names, unsigned features):
+        _memory(std::make_shared<_arena>()), _positional(get_allocator()), _named(get_allocator()),
+        _name_index(get_allocator()), _environment(get_allocator()), _declared_slots(get_allocator()),
+        _queried_absent(get_allocator()), _queried_positions(get_allocator()) {
         _main_argc = main_argc;
         _space_assignment = space_assignment;
         _strict = strict;
+        _features = features;
+        _declared_names = declared_names;
+        _declared_slots.resize(declared_names.count);
+        _argc = argc;
+        _argv = argv;
+
+        index_environment();
+        if(_features & _feature_cache)
+            open_cache(argc, argv);
+        if(_cache && _cache->load(_environment))
+            _executable = argv[0]; // Values come from the cache, argv is parsed only if it misses
+        else
+            parse_command_line();
+        check(false);
+    }
 
-        parse(argc, argv);
+    void _matcher::parse_command_line() {
+        parse(_argc, _argv);
         identifier help({"-h", "--help", "Print the help message"}, optional<int>());
         _help_flag = get_and_mark_as_queried(help).second != arg_type::none_t;
-        check(false);
+    }
+
+    void _matcher::open_cache(int argc, const char **argv) {
+        const string_view flag = "--fire-cache=";
+        std::string path;
+        for(int i = 1; i < argc; ++i)
+            if(string_view(argv[i]).substr(0, flag.size()) == flag)
+                path = argv[i] + flag.size();
+        if(path.empty())
+            return;
+
+        std::string inputs = "fire-cache-1";
+        inputs += std::to_string(sizeof(void *)) + std::to_string(sizeof(long double)) + std::to_string(_main_argc) +
+                  std::to_string(_space_assignment) + std::to_string(_strict) + std::to_string(_declared_names.count);
+        for(int i = 0; i < argc; ++i)
+            inputs.append(argv[i], std::char_traits<char>::length(argv[i]) + 1); // Terminators separate tokens
+        _cache = std::make_shared<_argument_cache>(path, (uint64_t) _string_view_hash()(inputs));
+
+        // A cache miss may parse argv after the constructor returns, when only the tokens are known to be alive
+        const char **copy = static_cast<const char **>(_memory->allocate(argc * sizeof(const char *), alignof(const char *)));
+        std::copy(argv, argv + argc, copy);
+        _argv = copy;
+    }
+
+    template <typename T>
+    bool _matcher::cache_load(const identifier &id, uint64_t schema, T &value) {
+        if(! _cache->hit())
+            return false;
+        if(_cache->read(schema, value)) {
+            _cache_served.push_back(id);
+            return true;
+        }
+        cache_recover();
+        return false;
+    }
+
+    template <typename T>
+    void _matcher::cache_store(const identifier &id, uint64_t schema, const T &value) {
+        if(id.get_env().has_value()) {
+            auto it = _environment.find(*id.get_env());
+            _cache->add_env(*id.get_env(), it != _environment.end() ? optional<string_view>(it->second) : optional<string_view>());
+        }
+        _cache->write(schema, value);
+    }
+
+    void _matcher::cache_unsupported() {
+        if(! _cache)
+            return;
+        if(_cache->hit())
+            cache_recover();
+        _cache->unsupported();
+    }
+
+    void _matcher::cache_recover() {
+        _cache->recover();
+        parse_command_line();
+        if(_strict)
+            for(const identifier &id: _cache_served)
+                mark_as_queried(id);
+        _cache_served.clear();
     }
 
     void _matcher::check(bool dec_main_argc) {
         _main_argc -= dec_main_argc;
         if(! _strict || _main_argc > 0) return;
 
+        if(_cache && _cache->hit() && ! _cache->exhausted())
+            cache_recover(); // Fewer arguments than in the cached run, so argv may have invalid ones
+
         if(_help_flag) {
-            _::help_logger.print_help();
-            exit(0);
+            std::string help = _::help_logger().help_text();
+            FIRE_TRACE_EMIT_();
+            _exit_or_throw(0, help);
         }
 
-        check_named();
-        check_positional();
+        {
+            FIRE_TRACE_SCOPE_("check", "");
+            check_named();
+            check_positional();
+        }
+        FIRE_TRACE_FINISH_();
 
         if(! _deferred_error.empty()) {
-            std::cerr << "Error: " << _deferred_error.get() << std::endl;
-            exit(_failure_code);
+            FIRE_TRACE_EMIT_();
+            _exit_or_throw(_failure_code, "Error: " + _deferred_error.get() + "\n");
         }
+
+        if(_cache)
+            _cache->save();
     }
 
     void _matcher::check_named() {
         int invalid_count = 0;
         std::string invalid;
         for(const auto &it: _named) {
-            for(const auto &jt: _queried)
-                if(jt.contains(it.first))
-                    goto VALID;
+            if(find_slot(it.first)->queried)
+                continue;
 
             ++invalid_count;
-            invalid += " " + identifier::prepend_hyphens(it.first);
-            VALID:;
+            invalid += ' ';
+            invalid += identifier::prepend_hyphens(it.first);
         }
         deferred_assert(identifier(), invalid.empty(),
-                        std::string("invalid argument") + (invalid_count > 1 ? "s" : "") + invalid);
+                        [&] { return std::string("invalid argument") + (invalid_count > 1 ? "s" : "") + invalid; });
     }
 
     void _matcher::check_positional() {
         int invalid_count = 0;
         std::string invalid;
         for(size_t i = 0; i < _positional.size(); ++i) {
-            for(const auto &it: _queried)
-                if(it.contains((int) i))
-                    goto VALID;
+            if(_all_positional_queried || _queried_positions.count((int) i))
+                continue;
 
             ++invalid_count;
             invalid += " " + std::to_string(i);
-            VALID:;
         }
         deferred_assert(identifier(), invalid.empty(),
-                        std::string("invalid positional argument") + (invalid_count > 1 ? "s" : "") + invalid);
+                        [&] { return std::string("invalid positional argument") + (invalid_count > 1 ? "s" : "") + invalid; });
+    }
+
+    void _matcher::release() {
+        std::vector<std::shared_ptr<_response_file>> files = std::move(_response_files);
+        std::vector<std::shared_ptr<_config_file>> configs = std::move(_config_files);
+        std::shared_ptr<_argument_cache> cache = std::move(_cache);
+        *this = _matcher();
+        _response_files = std::move(files); // string_view arguments may point into response, config or cache files
+        _config_files = std::move(configs);
+        _cache = std::move(cache);
+    }
+
+    const _matcher::_name_slot* _matcher::find_slot(const string_view &name) const {
+        size_t declared = _declared_names.find(name);
+        if(declared != _name_table_view::npos)
+            return &_declared_slots[declared];
+        auto it = _name_index.find(name);
+        return it != _name_index.end() ? &it->second : nullptr;
     }
 
-    std::pair<std::string, _matcher::arg_type> _matcher::get_and_mark_as_queried(const identifier &id) {
+    bool _matcher::is_queried(const identifier &id) const {
+        for(const optional<std::string> *name: {&id.get_short_name(), &id.get_long_name()}) {
+            if(! name->has_value()) continue;
+            const _name_slot *slot = find_slot(**name);
+            if(slot ? slot->queried : _queried_absent.count(**name))
+                return true;
+        }
+        if(id.get_pos().has_value()) {
+            int pos = id.get_pos().value();
+            return _queried_positions.count(pos) || (_all_positional_queried && pos < (int) _positional.size());
+        }
+        if(id.vector()) {
+            if(_all_positional_queried && ! _positional.empty())
+                return true;
+            for(int pos: _queried_positions)
+                if(pos < (int) _positional.size())
+                    return true;
+        }
+        return false;
+    }
+
+    void _matcher::mark_as_queried(const identifier &id) {
+        for(const optional<std::string> *name: {&id.get_short_name(), &id.get_long_name()}) {
+            if(! name->has_value()) continue;
+            _name_slot *slot = find_slot(**name);
+            if(slot) {
+                slot->queried = true;
+            } else {
+                if(! _memory)
+                    _memory = std::make_shared<_arena>();
+                _queried_absent.insert(_memory->copy(**name)); // Identifier is temporary
+            }
+        }
+        if(id.get_pos().has_value())
+            _queried_positions.insert(id.get_pos().value());
+        if(id.vector())
+            _all_positional_queried = true;
+    }
+
+    std::pair<string_view, _matcher::arg_type> _matcher::get_and_mark_as_queried(const identifier &id) {
         if(_space_assignment)
             _instant_assert(! id.get_pos().has_value(), "positional argument used with space assignement enabled: (disable space assignement by calling FIRE_NO_SPACE_ASSIGNMENT(...) instead of FIRE(...))");
 
-        for(const auto& it: _queried)
-            _instant_assert(! it.overlaps(id), "double query for argument " + id.longer());
+        _instant_assert(! is_queried(id), [&] { return "double query for argument " + id.longer(); });
+        if(! _declared_names.empty())
+            for(const optional<std::string> *name: {&id.get_short_name(), &id.get_long_name()})
+                if(name->has_value() && _declared_names.find(**name) == _name_table_view::npos)
+                    _instant_assert(false, [&] { return "argument " + **name + " is missing from FIRE_NAMES(...)"; });
 
         if (_strict)
-            _queried.push_back(id);
+            mark_as_queried(id);
+
+        size_t named = _not_given;
+        for(const optional<std::string> *name: {&id.get_short_name(), &id.get_long_name()}) {
+            if(! name->has_value()) continue;
+            const _name_slot *slot = find_slot(**name);
+            if(slot)
+                named = std::min(named, slot->named);
+        }
 
-        for(auto it = _named.begin(); it != _named.end(); ++it) {
-            if (id.contains(it->first)) {
-                optional<std::string> result = it->second;
-                if (result.has_value())
-                    return {result.value(), arg_type::string_t};
-                return {"", arg_type::bool_t};
-            }
+        if(named != _not_given) {
+            const optional<string_view> &result = _named[named].second;
+            if (result.has_value())
+                return {*result, arg_type::string_t};
+            return {"", arg_type::bool_t};
         }
 
         if(id.get_pos().has_value()) {
@@ -515,43 +2634,144 @@ namespace fire {
         return {"", arg_type::none_t};
     }
 
+    optional<std::pair<string_view, std::string>> _matcher::get_fallback(const identifier &id) {
+        if(id.get_env().has_value()) {
+            auto it = _environment.find(*id.get_env());
+            if(it != _environment.end())
+                return std::make_pair(it->second, "environment variable " + *id.get_env());
+        }
+
+        // Config keys are argument names without hyphens, the long name is preferred
+        for(auto file = _config_files.rbegin(); file != _config_files.rend(); ++file) {
+            for(const optional<std::string> *name: {&id.get_long_name(), &id.get_short_name()}) {
+                if(! name->has_value())
+                    continue;
+                string_view key = string_view(**name).substr(count_hyphens(**name)); // Looked up without a copy
+                optional<string_view> value = (*file)->get(key);
+                if(value.has_value())
+                    return std::make_pair(*value, "config file " + (*file)->path() + ", key " + key);
+            }
+        }
+        return {};
+    }
+
+    string_view _matcher::terminated(const string_view &value) {
+        for(const std::shared_ptr<_response_file> &file: _response_files)
+            if(file->contains(value))
+                return file->terminated(value);
+        return value;
+    }
+
+    void _matcher::terminate_positional() {
+        if(! _response_files.empty())
+            for(string_view &value: _positional)
+                value = terminated(value);
+    }
+
+    void _matcher::index_environment() { // Once per parse, instead of a linear getenv scan per argument
+#if defined(FIRE_POSIX_)
+        char **variables = environ;
+#elif defined(_WIN32)
+        char **variables = _environ;
+#else
+        char **variables = nullptr;
+#endif
+        for(; variables && *variables; ++variables) {
+            const char *equals = strchr(*variables, '=');
+            if(equals) // Like getenv, the first definition of a variable wins
+                _environment.emplace(string_view(*variables, equals - *variables), string_view(equals + 1));
+        }
+    }
+
     void _matcher::parse(int argc, const char **argv) {
+        FIRE_TRACE_SCOPE_("parse", "");
         _executable = argv[0];
-        std::vector<std::string> raw = to_vector_string(argc - 1, argv + 1);
-        std::vector<std::string> named;
+        _arena_vector<string_view> raw = load_config_files(expand_response_files(to_vector_string_view(argc - 1, argv + 1)));
+        _arena_vector<string_view> named;
         tie(named, _positional) = separate_named_positional(raw);
-        std::vector<std::pair<std::string, bool>> split = split_equations(named);
+        _arena_vector<std::pair<string_view, bool>> split = split_equations(named);
         _named = assign_named_values(split);
 
-        for(size_t i = 0; i < _named.size(); ++i)
-            for(size_t j = 0; j < i; ++j)
-                deferred_assert(identifier(), _named[i].first != _named[j].first,
-                                "multiple occurrences of argument " + identifier::prepend_hyphens(_named[i].first));
+        for(size_t i = 0; i < _named.size(); ++i) {
+            size_t declared = _declared_names.find(_named[i].first);
+            _name_slot &slot = declared != _name_table_view::npos ? _declared_slots[declared] : _name_index[_named[i].first];
+            if(slot.named == _not_given)
+                slot.named = i;
+            else
+                deferred_assert(identifier(), false,
+                                [&] { return "multiple occurrences of argument " + identifier::prepend_hyphens(_named[i].first); });
+        }
 
         if(_space_assignment)
             deferred_assert(identifier(), _positional.empty(), "positional arguments given, but not accepted");
     }
 
-    std::vector<std::string> _matcher::to_vector_string(int n_strings, const char **strings) {
-        std::vector<std::string> raw(n_strings);
+    _arena_vector<string_view> _matcher::expand_response_files(const _arena_vector<string_view> &raw) {
+        if(! (_features & _feature_response_files))
+            return raw;
+        _arena_vector<string_view> expanded(get_allocator());
+        expanded.reserve(raw.size());
+        for(const string_view &s: raw) {
+            if(s.size() >= 2 && s[0] == '@') {
+                if(_cache)
+                    _cache->add_file(s.c_str() + 1);
+                std::shared_ptr<_response_file> file = std::make_shared<_response_file>(s.c_str() + 1);
+                if(file->is_open()) { // Like in GCC, unreadable files are treated as literal arguments
+                    file->tokenize(expanded);
+                    _response_files.push_back(file);
+                    continue;
+                }
+            }
+            expanded.push_back(s);
+        }
+        return expanded;
+    }
+
+    _arena_vector<string_view> _matcher::load_config_files(const _arena_vector<string_view> &raw) {
+        const string_view flag = "--fire-config=", cache_flag = "--fire-cache="; // The latter is read by open_cache
+        if(! (_features & (_feature_cache | _feature_config)))
+            return raw;
+        _arena_vector<string_view> remaining(get_allocator());
+        remaining.reserve(raw.size());
+        for(const string_view &s: raw) {
+            if((_features & _feature_cache) && s.size() >= cache_flag.size() && s.substr(0, cache_flag.size()) == cache_flag)
+                continue;
+            if(! (_features & _feature_config) || s.size() < flag.size() || s.substr(0, flag.size()) != flag) {
+                remaining.push_back(s);
+                continue;
+            }
+
+            std::string path = s.substr(flag.size()).str();
+            if(_cache)
+                _cache->add_file(path);
+            std::shared_ptr<_config_file> file = std::make_shared<_config_file>(path.c_str());
+            deferred_assert(identifier(), file->is_open(), [&] { return "config file " + path + " can't be read"; });
+            deferred_assert(identifier(), file->error().empty(), [&] { return "config file " + file->error(); });
+            _config_files.push_back(file);
+        }
+        return remaining;
+    }
+
+    _arena_vector<string_view> _matcher::to_vector_string_view(int n_strings, const char **strings) {
+        _arena_vector<string_view> raw(n_strings, string_view(), get_allocator());
         for(int i = 0; i < n_strings; ++i)
             raw[i] = strings[i];
         return raw;
     }
 
-    std::tuple<std::vector<std::string>, std::vector<std::string>>
-            _matcher::separate_named_positional(const std::vector<std::string> &raw) {
-        std::vector<std::string> named, positional;
+    std::tuple<_arena_vector<string_view>, _arena_vector<string_view>>
+            _matcher::separate_named_positional(const _arena_vector<string_view> &raw) {
+        _arena_vector<string_view> named(get_allocator()), positional(get_allocator());
 
         bool to_named = false;
-        for(const std::string &s: raw) {
+        for(const string_view &s: raw) {
             int hyphens = count_hyphens(s);
             int name_size = (int) s.size() - hyphens;
-            deferred_assert(identifier(), hyphens <= 2, "too many hyphens: " + s);
+            deferred_assert(identifier(), hyphens <= 2, [&] { return "too many hyphens: " + s; });
             if(hyphens == 2 || (hyphens == 1 && name_size >= 1 && !isdigit(s[1]))) {
                 named.push_back(s);
                 to_named = hyphens >= 2 || name_size == 1; // Not "-abc" == "-a -b -c"
-                to_named &= (s.find('=') == std::string::npos); // No equation signs
+                to_named &= (s.find('=') == string_view::npos); // No equation signs
                 continue;
             }
             if(_space_assignment && to_named) {
@@ -562,22 +2782,23 @@ namespace fire {
             positional.push_back(s);
         }
 
-        return std::tuple<std::vector<std::string>, std::vector<std::string>>(named, positional);
+        return std::make_tuple(std::move(named), std::move(positional));
     }
 
-    std::vector<std::pair<std::string, bool>> _matcher::split_equations(const std::vector<std::string> &named) {
-        std::vector<std::pair<std::string, bool>> split; // std::string: parsed string, bool: is certainly value
-        for(const std::string &hyphened_name: named) {
+    _arena_vector<std::pair<string_view, bool>> _matcher::split_equations(const _arena_vector<string_view> &named) {
+        _arena_vector<std::pair<string_view, bool>> split(get_allocator()); // string_view: parsed string, bool: is certainly value
+        split.reserve(named.size());
+        for(const string_view &hyphened_name: named) {
             int hyphens = count_hyphens(hyphened_name);
             size_t eq = hyphened_name.find('=');
-            if(eq == std::string::npos) {
+            if(eq == string_view::npos) {
                 split.emplace_back(hyphened_name, false);
                 continue;
             }
             int name_size = (int) eq - hyphens;
 
             if(!deferred_assert(identifier(), name_size == 1 || hyphens >= 2,
-                                "expanding single-hyphen arguments can't have value (" + hyphened_name + ")")) continue;
+                                [&] { return "expanding single-hyphen arguments can't have value (" + hyphened_name + ")"; })) continue;
 
             split.emplace_back(hyphened_name.substr(0, eq), false);
             split.emplace_back(hyphened_name.substr(eq + 1), true);
@@ -585,12 +2806,13 @@ namespace fire {
         return split;
     }
 
-    std::vector<std::pair<std::string, optional<std::string>>>
-            _matcher::assign_named_values(const std::vector<std::pair<std::string, bool>> &split) {
-        std::vector<std::pair<std::string, optional<std::string>>> args;
+    _arena_vector<std::pair<string_view, optional<string_view>>>
+            _matcher::assign_named_values(const _arena_vector<std::pair<string_view, bool>> &split) {
+        _arena_vector<std::pair<string_view, optional<string_view>>> args(get_allocator());
+        args.reserve(split.size());
 
-        for(const std::pair<std::string, bool> &p: split) {
-            const std::string &name = p.first;
+        for(const std::pair<string_view, bool> &p: split) {
+            const string_view &name = p.first;
             bool certainly_value = p.second;
 
             int hyphens = count_hyphens(name);
@@ -598,21 +2820,44 @@ namespace fire {
                 args.back().second = name;
             } else if(hyphens == 2) {
                 deferred_assert(identifier(), name.size() >= 4,
-                                "single character parameter " + name + " must have exactly one hyphen");
-                args.emplace_back(name, optional<std::string>());
+                                [&] { return "single character parameter " + name + " must have exactly one hyphen"; });
+                args.emplace_back(name, optional<string_view>());
             } else if(hyphens == 1) {
                 if(isdigit(name[1]))
                     args.back().second = name;
+                else if(name.size() == 2)
+                    args.emplace_back(name, optional<string_view>());
                 else
                     for(size_t i = 1; i < name.size(); ++i)
-                        args.emplace_back(std::string("-") + name[i], optional<std::string>());
+                        args.emplace_back(expanded_shorthand(name[i]), optional<string_view>());
             } else if(hyphens == 0)
                 args.back().second = name;
         }
         return args;
     }
 
-    bool _matcher::deferred_assert(const identifier &id, bool pass, const std::string &msg) {
+    string_view _matcher::expanded_shorthand(char c) {
+        struct table { // Static storage for names expanded from "-abc" to "-a -b -c"
+            char names[256][2];
+            table() {
+                for(int i = 0; i < 256; ++i) {
+                    names[i][0] = '-';
+                    names[i][1] = (char) i;
+                }
+            }
+        };
+        static const table shorthands;
+        return string_view(shorthands.names[(unsigned char) c], 2);
+    }
+
+    template <typename F, typename>
+    bool _matcher::deferred_assert(const identifier &id, bool pass, const F &build_msg) {
+        if(! pass)
+            deferred_assert(id, pass, std::string(build_msg()).c_str());
+        return pass;
+    }
+
+    bool _matcher::deferred_assert(const identifier &id, bool pass, const char *msg) {
         if(! _strict) {
             _instant_assert(pass, msg, false);
             return pass;
@@ -643,16 +2888,28 @@ namespace fire {
         options += "      " + printable + std::string(2 + margin - printable.size(), ' ') + elem.descr;
         if(! elem.def.empty())
             options += " [default: " + elem.def + "]";
+        if(id.get_env().has_value())
+            options += " [env: " + id.get_env().value() + "]";
         options += "\n";
     }
 
+    void release() {
+        _::help_logger() = _help_logger();
+        _::matcher().release();
+    }
+
     void _help_logger::print_help() {
+        std::cerr << help_text() << std::flush;
+    }
+
+    std::string _help_logger::help_text() {
+        FIRE_TRACE_SCOPE_("print_help", "");
         using id2elem = std::pair<identifier, log_elem>;
 
-        std::string usage = "    Usage:\n      " + _::matcher.get_executable();
+        std::string usage = "    Usage:\n      " + _::matcher().get_executable();
         std::string options = "    Options:\n";
 
-        std::vector<id2elem> printed(_params);
+        std::vector<id2elem> printed(_params.begin(), _params.end());
         for(id2elem &elem: printed)
             elem.first.set_optional(elem.second.optional);
 
@@ -667,7 +2924,7 @@ namespace fire {
         for(const auto& it: printed)
             _add_to_help(usage, options, it.first, it.second, margin);
 
-        std::cerr << std::endl << usage << std::endl << std::endl << std::endl << options << std::endl;
+        return "\n" + usage + "\n\n\n" + options + "\n";
     }
 
     void _help_logger::log(const identifier &name, const log_elem &_elem) {
@@ -676,85 +2933,70 @@ namespace fire {
         _params.emplace_back(name, elem);
     }
 
-    template <>
-    inline optional<long long> arg::_get<long long>() {
-        auto elem = _::matcher.get_and_mark_as_queried(_id);
-        _::matcher.deferred_assert(_id, elem.second != _matcher::arg_type::bool_t,
-                                   "argument " + _id.help() + " must have value");
-        if(elem.second == _matcher::arg_type::string_t) {
-            size_t last = 0;
-            bool is_int = true;
-            long long converted = 0;
-            try {
-                converted = std::stoll(elem.first, &last);
-            } catch(std::out_of_range &) {
-                _::matcher.deferred_assert(_id, false, "value " + elem.first + " out of range");
-            } catch(std::invalid_argument &) {
-                is_int = false;
-            }
-
-            _::matcher.deferred_assert(_id, is_int && last == elem.first.size(), // last != elem.first.size() indicates floating point
-                                       "value " + elem.first + " is not an integer");
-
-            return converted;
+    template <typename T>
+    optional<T> arg::_get() {
+        auto elem = _::matcher().get_and_mark_as_queried(_id);
+        _::matcher().deferred_assert(_id, elem.second != _matcher::arg_type::bool_t,
+                                   [&] { return "argument " + _id.help() + " must have value"; });
+        if(elem.second == _matcher::arg_type::string_t)
+            return _parse<T>(_needs_terminator<T>::value ? _::matcher().terminated(elem.first) : elem.first);
+        if(elem.second == _matcher::arg_type::none_t) {
+            optional<std::pair<string_view, std::string>> fallback = _::matcher().get_fallback(_id);
+            if(fallback.has_value())
+                return _parse<T>((*fallback).first, (*fallback).second);
         }
-
-        return _int_value;
+        return _get_default<T>();
     }
 
-    template <>
-    inline optional<long double> arg::_get<long double>() {
-        auto elem = _::matcher.get_and_mark_as_queried(_id);
-        _::matcher.deferred_assert(_id, elem.second != _matcher::arg_type::bool_t,
-                                   "argument " + _id.help() + " must have value");
-        if(elem.second == _matcher::arg_type::string_t) {
-            try {
-                return std::stold(elem.first);
-            } catch(std::out_of_range &) {
-                _::matcher.deferred_assert(_id, false, "value " + elem.first + " out of range");
-            } catch(std::invalid_argument &) {
-                _::matcher.deferred_assert(_id, false, "value " + elem.first + " is not a real number");
-            }
-        }
+    template <typename T>
+    optional<T> arg::_parse(const string_view &value, const std::string &origin) {
+        T converted = T();
+        _conversion result = _parse_value(value, converted);
+        _::matcher().deferred_assert(_id, result == _conversion::ok, [&] {
+            std::string msg = _conversion_error<T>(result, value, _id);
+            return origin.empty() ? msg : origin + ": " + msg;
+        });
+        if(result != _conversion::ok)
+            return {};
+        return converted;
+    }
 
-        if(_float_value.has_value()) return _float_value;
-        if(_int_value.has_value()) return (long double) _int_value.value();
+    template <typename T, typename std::enable_if<std::is_floating_point<T>::value>::type*>
+    optional<T> arg::_get_default() {
+        if(_float_value.has_value()) return _narrow<T>(_float_value);
+        if(_int_value.has_value()) return _narrow<T>((long double) _int_value.value());
         return {};
     }
 
-    template <>
-    inline optional<std::string> arg::_get<std::string>() {
-        auto elem = _::matcher.get_and_mark_as_queried(_id);
-        _::matcher.deferred_assert(_id, elem.second != _matcher::arg_type::bool_t,
-                                   "argument " + _id.help() + " must have value");
-
-        if(elem.second == _matcher::arg_type::string_t)
-            return elem.first;
-        return _string_value;
+    template <typename T, typename std::enable_if<std::is_same<T, string_view>::value>::type*>
+    optional<T> arg::_get_default() {
+        if(_literal_value.has_value())
+            return string_view(*_literal_value);
+        if(_string_value.has_value())
+            return string_view(*_string_value); // Valid while this arg lives
+        return {};
     }
 
     template <typename T, typename std::enable_if<std::is_integral<T>::value && ! std::is_same<T, bool>::value>::type*>
-    optional<T> arg::_get_with_precision() {
-        optional<long long> opt_value = _get<long long>();
+    optional<T> arg::_narrow(const optional<long long> &opt_value) {
         if(! opt_value.has_value())
             return optional<T>();
         long long value = opt_value.value();
 
         bool is_signed = std::numeric_limits<T>::is_signed;
-        T min = std::numeric_limits<T>::lowest();
-        T max = std::numeric_limits<T>::max();
+        long long min = (long long) std::numeric_limits<T>::lowest();
+        unsigned long long max = (unsigned long long) std::numeric_limits<T>::max();
 
-        _::matcher.deferred_assert(_id, is_signed || value >= 0,
-                                   "argument " + _id.help() + " must be positive");
-        _::matcher.deferred_assert(_id, min <= value && value <= max,
-                                   "value " + std::to_string(value) + " out of range");
+        _::matcher().deferred_assert(_id, is_signed || value >= 0,
+                                   [&] { return "argument " + _id.help() + " must be positive"; });
+        _::matcher().deferred_assert(_id, value < 0 ? min <= value : (unsigned long long) value <= max,
+                                   [&] { return "value " + std::to_string(value) + " out of range"; });
 
         return (T) value;
     }
 
     template <typename T, typename std::enable_if<std::is_floating_point<T>::value>::type*>
-    optional<T> arg::_get_with_precision() {
-        optional<long double> opt_value = _get<long double>();
+    optional<T> arg::_narrow(const optional<long double> &opt_value) {
         if(! opt_value.has_value())
             return optional<T>();
         long double value = opt_value.value();
@@ -762,37 +3004,84 @@ namespace fire {
         T min = std::numeric_limits<T>::lowest();
         T max = std::numeric_limits<T>::max();
 
-        _::matcher.deferred_assert(_id, min <= value && value <= max,
-                                   "value " + std::to_string(value) + " out of range");
+        _::matcher().deferred_assert(_id, min <= value && value <= max,
+                                   [&] { return "value " + std::to_string(value) + " out of range"; });
 
         return (T) value;
     }
 
     template <typename T>
-    optional<T> arg::_convert_optional(bool dec_main_argc) {
+    uint64_t arg::_schema(const char *kind) const {
+        std::string schema = std::string(kind) + '\0' + _id.help() + '\0' + _id.longer() + '\0' + _id.get_env().value_or("");
+        schema += '\0' + std::to_string(sizeof(T)) + (std::is_signed<T>::value ? "s" : "u") +
+                  (std::is_floating_point<T>::value ? "f" : std::is_integral<T>::value ? "i" :
+                   std::is_same<T, string_view>::value ? "v" : "t");
+        if(_int_value.has_value())
+            schema += std::string("\0i", 2) + std::to_string(_int_value.value());
+        if(_float_value.has_value()) { // Hexadecimal is exact, and unlike the bytes of long double it has no padding
+            char hex[64];
+            std::snprintf(hex, sizeof(hex), "%La", _float_value.value());
+            schema += std::string("\0f", 2) + hex;
+        }
+        if(_string_value.has_value())
+            schema += std::string("\0s", 2) + _string_value.value();
+        return (uint64_t) _string_view_hash()(schema);
+    }
+
+    template <typename T>
+    bool arg::_load_cached(const char *kind, T &value, bool dec_main_argc) {
+        if(! _::matcher().caching() || ! _::matcher().cache_load(_id, _schema<T>(kind), value))
+            return false;
+        _::matcher().check(dec_main_argc);
+        return true;
+    }
+
+    template <typename T>
+    void arg::_store_cached(const char *kind, const T &value) {
+        if(_::matcher().caching())
+            _::matcher().cache_store(_id, _schema<T>(kind), value);
+    }
+
+    template <typename T>
+    optional<T> arg::_convert_optional(const char *type, bool dec_main_argc) {
+        FIRE_TRACE_SCOPE_("arg", _id.longer());
+        optional<T> val;
+        if(_load_cached("optional", val, dec_main_argc))
+            return val;
+        _log(type, true);
         _instant_assert(! (_int_value.has_value() || _float_value.has_value() || _string_value.has_value()),
                         "optional argument has default value");
-        optional<T> val = _get_with_precision<T>();
-        _::matcher.check(dec_main_argc);
+        val = _get<T>();
+        _store_cached("optional", val);
+        _::matcher().check(dec_main_argc);
         return val;
     }
 
     template <typename T>
-    T arg::_convert(bool dec_main_argc) {
-        optional<T> val = _get_with_precision<T>();
-        _::matcher.deferred_assert(_id, val.has_value(),
-                                   "required argument " + _id.longer() + " not provided");
-        _::matcher.check(dec_main_argc);
+    T arg::_convert(const char *type, bool dec_main_argc) {
+        FIRE_TRACE_SCOPE_("arg", _id.longer());
+        T cached = T();
+        if(_load_cached("value", cached, dec_main_argc))
+            return cached;
+        _log(type, false);
+        optional<T> val = _get<T>();
+        _::matcher().deferred_assert(_id, val.has_value(),
+                                   [&] { return "required argument " + _id.longer() + " not provided"; });
+        _store_cached("value", val.value_or(T()));
+        _::matcher().check(dec_main_argc);
         return val.value_or(T());
     }
 
-    void arg::_log(const std::string &type, bool optional) {
+    void arg::_log(const char *type, bool optional) {
+        if(! _::matcher().help_requested()) // Help is only printed if requested, so don't gather it otherwise
+            return;
+
         std::string def;
         if(_int_value.has_value()) def = std::to_string(_int_value.value());
         if(_float_value.has_value()) def = std::to_string(_float_value.value());
         if(_string_value.has_value()) def = _string_value.value();
 
-        _::help_logger.log(_id, {_id.get_descr(), type, def, optional});
+        _::help_logger().log(_id, {_id.get_descr(), type, def, optional});
     }
 
     arg arg::vector(std::string descr) {
@@ -802,50 +3091,689 @@ namespace fire {
     }
 
     arg::operator bool() {
+        FIRE_TRACE_SCOPE_("arg", _id.longer());
+        bool cached = false;
+        if(_load_cached("flag", cached))
+            return cached;
         _instant_assert(!_int_value.has_value() && !_float_value.has_value() && !_string_value.has_value(),
-                _id.longer() + " flag parameter must not have default value");
+                [&] { return _id.longer() + " flag parameter must not have default value"; });
 
         _log("", true); // User sees this as flag, not boolean option
-        auto elem = _::matcher.get_and_mark_as_queried(_id);
-        _::matcher.deferred_assert(_id, elem.second != _matcher::arg_type::string_t,
-                                   "flag " + _id.help() + " must not have value");
-        _::matcher.check(true);
+        auto elem = _::matcher().get_and_mark_as_queried(_id);
+        _::matcher().deferred_assert(_id, elem.second != _matcher::arg_type::string_t,
+                                   [&] { return "flag " + _id.help() + " must not have value"; });
+        optional<std::pair<string_view, std::string>> fallback;
+        if(elem.second == _matcher::arg_type::none_t)
+            fallback = _::matcher().get_fallback(_id);
+        if(fallback.has_value()) { // Empty, 0 and false unset the flag, 1 and true set it
+            const string_view &value = (*fallback).first;
+            bool unset = value == "" || value == "0" || value == "false";
+            bool set = value == "1" || value == "true";
+            _::matcher().deferred_assert(_id, set || unset, [&] {
+                return (*fallback).second + ": value " + value + " is not a flag (0/1/false/true)";
+            });
+            _store_cached("flag", set);
+            _::matcher().check(true);
+            return set;
+        }
+        _store_cached("flag", elem.second == _matcher::arg_type::bool_t);
+        _::matcher().check(true);
         return elem.second == _matcher::arg_type::bool_t;
     }
 
     template <typename T>
     arg::operator std::vector<T>() {
+        return _convert_vector<T>([this](const _arena_vector<string_view> &values) { return _parse_vector<T>(values); });
+    }
+
+    template <typename T>
+    _parallel_vector::operator std::vector<T>() {
+        return _arg._convert_vector<T>([this](const _arena_vector<string_view> &values) {
+            return _arg._parse_vector<T>(values, _threads);
+        });
+    }
+
+    template <typename T, typename P>
+    std::vector<T> arg::_convert_vector(const P &parse) {
+        FIRE_TRACE_SCOPE_("arg", _id.longer());
         std::vector<T> ret;
-        for(size_t i = 0; i < _::matcher.pos_args(); ++i)
-            ret.push_back(arg((int) i)._convert<T>(false));
+        if(_load_cached("vector", ret))
+            return ret;
+        _::matcher().get_and_mark_as_queried(_id); // Marks all positional arguments at once
+        if(_needs_terminator<T>::value)
+            _::matcher().terminate_positional();
+        const _arena_vector<string_view> &positional = _::matcher().get_positional();
+
+        ret = parse(positional);
         _log("", true);
-        _::matcher.check(true);
+        _store_cached("vector", ret);
+        _::matcher().check(true);
+        return ret;
+    }
+
+    template <typename T>
+    std::vector<T> arg::_parse_vector(const _arena_vector<string_view> &values) {
+        std::vector<T> ret(values.size());
+        _conversion result = _conversion::ok;
+        size_t failed = _parse_range(values.data(), values.size(), ret.data(), result);
+        if(failed != values.size()) {
+            ret[failed] = T();
+            _::matcher().deferred_assert(_id, false, [&] { return _conversion_error<T>(result, values[failed], _id); });
+        }
+        return ret;
+    }
+
+    template <typename T>
+    std::vector<T> arg::_parse_vector(const _arena_vector<string_view> &values, unsigned requested_threads) {
+        size_t threads = requested_threads ? requested_threads : std::max(1u, std::thread::hardware_concurrency());
+        threads = std::max((size_t) 1, std::min(threads, values.size() / _min_parallel_chunk));
+
+        struct failure {
+            size_t index;
+            _conversion result;
+        };
+        std::vector<T> ret(values.size());
+        std::vector<failure> failures(threads, {values.size(), _conversion::ok}); // First failure of each chunk
+
+        auto convert_chunk = [&](size_t chunk) { // Chunks are contiguous and in order, each thread writes its own
+            size_t begin = values.size() * chunk / threads, end = values.size() * (chunk + 1) / threads;
+            _conversion result = _conversion::ok;
+            size_t failed = begin + _parse_range(values.data() + begin, end - begin, ret.data() + begin, result);
+            if(failed != end) {
+                ret[failed] = T();
+                failures[chunk] = {failed, result};
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for(size_t chunk = 1; chunk < threads; ++chunk)
+            workers.emplace_back(convert_chunk, chunk);
+        convert_chunk(0);
+        for(std::thread &worker: workers)
+            worker.join();
+
+        for(const failure &f: failures) { // Lowest failing index, as reported by the single-threaded conversion
+            if(f.index == values.size())
+                continue;
+            _::matcher().deferred_assert(_id, false, [&] { return _conversion_error<T>(f.result, values[f.index], _id); });
+            break;
+        }
         return ret;
     }
+
+    template <typename T>
+    arg::operator stream<T>() {
+        FIRE_TRACE_SCOPE_("arg", _id.longer());
+        _::matcher().cache_unsupported(); // Values are converted after fired_main starts
+        _::matcher().get_and_mark_as_queried(_id); // Marks all positional arguments at once
+        _log("", true);
+        _::matcher().check(true);
+        const _arena_vector<string_view> &positional = _::matcher().get_positional();
+        return stream<T>(positional.data(), positional.data() + positional.size(),
+                         _::matcher().get_allocator().arena, _::matcher().get_response_files(), _id);
+    }
+
+
+    template <typename T>
+    stream<T>::stream(const string_view *begin, const string_view *end, std::shared_ptr<_arena> memory,
+                      std::vector<std::shared_ptr<_response_file>> files, const identifier &id):
+        _from_stdin(end - begin == 1 && *begin == "-"), _id(id) {
+        if(_from_stdin) // Whitespace separated tokens are read in next()
+            return;
+        _state = std::make_shared<state>();
+        _state->begin = begin;
+        _state->end = end;
+        _state->memory = std::move(memory);
+        _state->files = std::move(files);
+        _state->id = id;
+        _state->producer = std::thread(_produce, _state);
+    }
+
+    template <typename T>
+    stream<T>::~stream() {
+        if(! _state)
+            return;
+        {
+            std::lock_guard<std::mutex> lock(_state->mutex);
+            _state->stop = true;
+        }
+        _state->changed.notify_all();
+        _state->producer.join();
+    }
+
+    template <typename T>
+    bool stream<T>::_push(state &st, chunk &c) {
+        std::unique_lock<std::mutex> lock(st.mutex);
+        st.changed.wait(lock, [&st] { return st.stop || st.queue.size() < _max_chunks; });
+        if(st.stop)
+            return false;
+        st.queue.push_back(std::move(c));
+        lock.unlock();
+        st.changed.notify_all();
+
+        c = chunk();
+        c.values.reserve(_chunk_size);
+        return true;
+    }
+
+    template <typename T>
+    void stream<T>::_produce(std::shared_ptr<state> st) {
+        chunk c;
+        c.values.reserve(_chunk_size);
+        auto convert = [&](const string_view &token) { // Returns false if the stream ends here
+            T value = T();
+            _conversion result = _parse_value(token, value);
+            if(result != _conversion::ok) {
+                c.error = _conversion_error<T>(result, token, st->id);
+                return false;
+            }
+            c.values.push_back(std::move(value));
+            return c.values.size() < _chunk_size || _push(*st, c);
+        };
+
+        for(const string_view *token = st->begin; token != st->end; ++token)
+            if(! convert(*token))
+                break;
+
+        _push(*st, c);
+        {
+            std::lock_guard<std::mutex> lock(st->mutex);
+            st->done = true;
+        }
+        st->changed.notify_all();
+    }
+
+    template <typename T>
+    bool stream<T>::next(T &value) {
+        if(_from_stdin) {
+            std::string token;
+            if(! (std::cin >> token))
+                return false;
+            _conversion result = _parse_value(string_view(token), value);
+            _instant_assert(result == _conversion::ok, [&] { return _conversion_error<T>(result, token, _id); }, false);
+            return true;
+        }
+
+        while(_next == _current.values.size()) {
+            _instant_assert(_current.error.empty(), _current.error.c_str(), false);
+
+            std::unique_lock<std::mutex> lock(_state->mutex);
+            _state->changed.wait(lock, [this] { return ! _state->queue.empty() || _state->done; });
+            if(_state->queue.empty())
+                return false;
+            _current = std::move(_state->queue.front());
+            _state->queue.pop_front();
+            _next = 0;
+            lock.unlock();
+            _state->changed.notify_all();
+        }
+
+        value = std::move(_current.values[_next++]);
+        return true;
+    }
+
+    template <typename F, typename C>
+    auto parser::run(int argc, const char **argv, F fired_main, const C &call, bool space_assignment,
+                     const _name_table_view &declared_names) -> decltype(call()) {
+        _activation activation(_state);
+        int main_argc = (int) _get_argument_count(fired_main);
+        bool strict = true;
+        try {
+            _state.help_logger = _help_logger();
+            _state.matcher = _matcher(argc, argv, main_argc, space_assignment, strict, declared_names, _state.features);
+            _state.help_logger = _help_logger(_state.matcher.get_allocator());
+            return call();
+        } catch(const error &) { // Leave the parser empty and ready for the next run
+            _state.help_logger = _help_logger();
+            _state.matcher = _matcher();
+            throw;
+        }
+    }
+
+    int _run_subcommand(parser &p, int argc, const char **argv, const _name_table_view &subcommands,
+                        const _subcommand_handler *handlers, bool space_assignment) {
+        string_view name = argc > 1 ? string_view(argv[1]) : string_view();
+        size_t selected = subcommands.find(name);
+        if(selected == _name_table_view::npos) {
+            parser::_activation activation(p._state); // Errors follow the on_error mode of p
+            std::string listing = "\n    Usage:\n      " + std::string(argv[0]) + " SUBCOMMAND ...\n\n\n    Subcommands:\n";
+            for(size_t i = 0; i < subcommands.count; ++i)
+                listing += "      " + std::string(subcommands.names[i]) + "\n";
+            listing += "\n";
+
+            if(name == "-h" || name == "--help")
+                _exit_or_throw(0, listing);
+            _exit_or_throw(_failure_code, (argc > 1 ? "Error: unknown subcommand " + std::string(argv[1]) :
+                                                      std::string("Error: subcommand required")) + "\n" + listing);
+        }
+
+        std::string executable = std::string(argv[0]) + " " + argv[1]; // Shown in the help of the subcommand
+        std::vector<const char *> sub_argv(argv + 1, argv + argc + 1);
+        sub_argv[0] = executable.c_str();
+
+        return handlers[selected](p, argc - 1, sub_argv.data(), space_assignment);
+    }
+
+    std::vector<std::string> _help_option_names(const std::string &help) {
+        std::vector<std::string> names;
+        size_t pos = help.find("    Options:\n");
+        if(pos == std::string::npos)
+            return names;
+
+        for(pos += 13; pos < help.size();) { // Each option line starts with its printable form, e.g. [-t|--threads=INTEGER]
+            size_t line_end = std::min(help.find('\n', pos), help.size());
+            size_t begin = help.find_first_not_of(" [", pos);
+            if(begin < line_end && help[begin] == '-') {
+                size_t end = std::min(help.find_first_of(" =]", begin), line_end);
+                for(size_t i = begin; i < end; i = std::min(help.find('|', i), end) + 1)
+                    names.push_back(help.substr(i, std::min(help.find('|', i), end) - i));
+            }
+            pos = line_end + 1;
+        }
+        return names;
+    }
+
+    template <typename F>
+    std::string _complete(int argc, const char **argv, const _name_table_view &options,
+                          const _name_table_view &subcommands, const F &run_with) {
+        _instant_assert(argc >= 4, "usage: --fire-complete <cword> <words...>", false);
+        char *end;
+        long cword = std::strtol(argv[2], &end, 10);
+        const char **words = argv + 3;
+        long word_count = argc - 3;
+        _instant_assert(*argv[2] && ! *end && cword > 0 && cword <= word_count,
+                        "--fire-complete <cword> must index <words...> or the word after them", false);
+        string_view current = cword < word_count ? string_view(words[cword]) : string_view();
+
+        std::vector<std::string> names;
+        if(! subcommands.empty() && cword == 1) {
+            names.assign(subcommands.names, subcommands.names + subcommands.count);
+        } else if(! current.empty() && current[0] == '-') { // Other words may be values, left to the shell
+            if(! options.empty()) {
+                names.assign(options.names, options.names + options.count);
+            } else {
+                std::vector<const char *> help_argv(argv, argv + 1);
+                if(! subcommands.empty())
+                    help_argv.push_back(words[1]);
+                help_argv.push_back("--help");
+                help_argv.push_back(nullptr);
+
+                parser p(on_error::throw_exception);
+                try {
+                    run_with(p, (int) help_argv.size() - 1, help_argv.data());
+                } catch(const error &e) {
+                    if(e.code() == 0)
+                        names = _help_option_names(e.what());
+                }
+            }
+        }
+
+        std::string output;
+        for(const std::string &name: names) {
+            if(name.compare(0, current.size(), current.data(), current.size()) != 0)
+                continue;
+            bool used = false; // Each option is offered until it's given
+            for(long i = 1; i < word_count && ! used; ++i) {
+                string_view word = words[i];
+                used = i != cword && word.substr(0, word.find('=')) == name;
+            }
+            if(! used)
+                output += name + "\n";
+        }
+        return output;
+    }
+
+    std::string _completion_script(const std::string &shell, const char *executable) {
+        std::string program = executable;
+        program = program.substr(program.find_last_of("/\\") + 1);
+        std::string function = "_fire_complete_";
+        for(char c: program)
+            function += std::isalnum((unsigned char) c) ? c : '_';
+
+        if(shell == "bash")
+            return function + "() {\n"
+                   "    local IFS=$'\\n'\n"
+                   "    COMPREPLY=($(\"${COMP_WORDS[0]}\" --fire-complete \"$COMP_CWORD\" \"${COMP_WORDS[@]}\" 2>/dev/null))\n"
+                   "}\n"
+                   "complete -o default -F " + function + " " + program + "\n";
+
+        _instant_assert(shell == "zsh", [&] { return "--fire-complete-script supports bash and zsh, not " + shell; }, false);
+        return "#compdef " + program + "\n" +
+               function + "() {\n"
+               "    local -a candidates\n"
+               "    candidates=(${(f)\"$(\"${words[1]}\" --fire-complete $((CURRENT - 1)) \"${words[@]}\" 2>/dev/null)\"})\n"
+               "    if (( ${#candidates} )); then\n"
+               "        compadd -a candidates\n"
+               "    else\n"
+               "        _files\n"
+               "    fi\n"
+               "}\n"
+               "compdef " + function + " " + program + "\n";
+    }
+
+    template <typename F>
+    int _run_main(int argc, const char **argv, const F &run_with,
+                  const _name_table_view &options, const _name_table_view &subcommands, unsigned features) {
+        const string_view complete = "--fire-complete", script = "--fire-complete-script=";
+        string_view first = argc > 1 ? string_view(argv[1]) : string_view();
+        // Completion is answered before any argument setup
+        if((features & _feature_complete) && (first == complete || first.substr(0, script.size()) == script)) {
+            std::string output = first == complete ? _complete(argc, argv, options, subcommands, run_with) :
+                                 _completion_script(std::string(first.substr(script.size())), argv[0]);
+            std::fwrite(output.data(), 1, output.size(), stdout);
+            return 0;
+        }
+
+        auto enable_files = [features](parser &p) {
+            p.enable_cache((features & _feature_cache) != 0);
+            p.enable_config((features & _feature_config) != 0);
+            p.enable_response_files((features & _feature_response_files) != 0);
+        };
+
+        const string_view flag = "--fire-batch";
+        if(! (features & _feature_batch) || first.substr(0, flag.size()) != flag ||
+           (first.size() > flag.size() && first[flag.size()] != '=')) {
+            parser p;
+            enable_files(p);
+            return run_with(p, argc, argv);
+        }
+
+        _instant_assert(argc == 2, "--fire-batch can't be combined with other arguments", false);
+        std::string path = first.size() > flag.size() ? std::string(first.substr(flag.size() + 1)) : "-";
+        std::ifstream file;
+        if(path != "-") {
+            file.open(path);
+            _instant_assert(file.is_open(), [&] { return "can't open batch file " + path; }, false);
+        }
+        std::istream &lines = path == "-" ? std::cin : file;
+
+        parser p(on_error::throw_exception); // A failing line is reported and the batch continues
+        enable_files(p);
+        int result = 0; // First nonzero exit code
+        size_t number = 0;
+        for(std::string line; std::getline(lines, line);) {
+            ++number;
+            size_t content_start = line.find_first_not_of(" \t\r\n\v\f");
+            if(content_start == std::string::npos || line[content_start] == '#') // Blank or comment
+                continue;
+
+            _arena copies;
+            _arena_vector<string_view> tokens;
+            _tokenize(line.data(), line.size(), copies, tokens);
+
+            std::vector<const char *> line_argv(1, argv[0]);
+            for(const string_view &token: tokens)
+                line_argv.push_back(copies.copy(token).data()); // Plain tokens are views into line, without terminators
+            line_argv.push_back(nullptr);
+
+            int code;
+            try {
+                code = run_with(p, (int) line_argv.size() - 1, line_argv.data());
+            } catch(const error &e) {
+                std::cerr << e.what() << std::flush;
+                code = e.code();
+            }
+            if(code != 0)
+                std::cerr << "Batch line " << number << ": exit code " << code << std::endl;
+            if(result == 0)
+                result = code;
+        }
+        return result;
+    }
+
+#ifdef FIRE_TRACE
+    _trace_scope::_trace_scope(const char *phase, std::string name):
+        _phase(phase), _name(std::move(name)), _start(std::chrono::steady_clock::now()),
+        _allocations(_trace::allocations), _bytes(_trace::bytes),
+        _own_allocations(_trace::own_allocations), _own_bytes(_trace::own_bytes) {
+        ++_trace::depth;
+    }
+
+    _trace_scope::~_trace_scope() {
+        long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count();
+        size_t before_allocations = _trace::allocations, before_bytes = _trace::bytes;
+        size_t allocations = before_allocations - _allocations - (_trace::own_allocations - _own_allocations);
+        size_t bytes = before_bytes - _bytes - (_trace::own_bytes - _own_bytes);
+
+        std::string name;
+        for(char c: _name) {
+            if(c == '"' || c == '\\') name += '\\';
+            name += c;
+        }
+        _trace::phases.push_back("{\"phase\": \"" + std::string(_phase) + "\", \"name\": \"" + name +
+                                 "\", \"ns\": " + std::to_string(ns) + ", \"allocations\": " + std::to_string(allocations) +
+                                 ", \"bytes\": " + std::to_string(bytes) + "}");
+        _trace::own_allocations += _trace::allocations - before_allocations;
+        _trace::own_bytes += _trace::bytes - before_bytes;
+        if(--_trace::depth == 0 && _trace::pending)
+            _trace_emit();
+    }
+
+    void _trace_finish() {
+        _trace::pending = true;
+        if(_trace::depth == 0)
+            _trace_emit();
+    }
+
+    void _trace_emit() {
+        if(_trace::emitted.exchange(true)) return;
+
+        long peak_rss_kb = -1;
+#ifdef FIRE_POSIX_
+        rusage usage;
+        if(getrusage(RUSAGE_SELF, &usage) == 0)
+            peak_rss_kb = (long) usage.ru_maxrss;
+#ifdef __APPLE__
+        peak_rss_kb /= 1024; // Bytes on Mac OS
+#endif
+#endif
+
+        std::string record = "{\"fire_trace\": 1, \"phases\": [";
+        for(size_t i = 0; i < _trace::phases.size(); ++i)
+            record += (i ? ", " : "") + _trace::phases[i];
+        record += "], \"allocations\": " + std::to_string(_trace::allocations) +
+                  ", \"bytes\": " + std::to_string(_trace::bytes) +
+                  ", \"peak_rss_kb\": " + std::to_string(peak_rss_kb) + "}\n";
+
+#ifdef FIRE_POSIX_
+        int fd = 2; // Unless FIRE_TRACE is a whole non-negative number
+        if(const char *variable = getenv("FIRE_TRACE")) {
+            char *end;
+            long parsed = std::strtol(variable, &end, 10);
+            if(*variable && ! *end && parsed >= 0 && parsed <= std::numeric_limits<int>::max())
+                fd = (int) parsed;
+        }
+        if(write(fd, record.data(), record.size()) >= 0)
+            return;
+#endif
+        std::cerr << record << std::flush;
+    }
+#endif
 }
 
 
 
 template<typename F>
-void init_and_run(int argc, const char ** argv, F main_func, bool space_assignment) {
+void init_and_run(int argc, const char ** argv, F main_func, bool space_assignment,
+                  const fire::_name_table_view &declared_names = fire::_name_table_view()) {
     int main_argc = (int) fire::_get_argument_count(main_func);
     bool strict = true;
-    fire::_::help_logger = fire::_help_logger();
-    fire::_::matcher = fire::_matcher(argc, argv, main_argc, space_assignment, strict);
+    fire::_::help_logger() = fire::_help_logger();
+    fire::_::matcher() = fire::_matcher(argc, argv, main_argc, space_assignment, strict, declared_names);
+    fire::_::help_logger() = fire::_help_logger(fire::_::matcher().get_allocator());
+}
+
+#ifdef FIRE_CACHE // Programs accept --fire-cache=FILE only if defined before including fire.hpp
+#define FIRE_CACHE_FEATURE_ fire::_feature_cache
+#else
+#define FIRE_CACHE_FEATURE_ 0u
+#endif
+
+#ifdef FIRE_BATCH // Programs accept --fire-batch[=FILE] only if defined before including fire.hpp
+#define FIRE_BATCH_FEATURE_ fire::_feature_batch
+#else
+#define FIRE_BATCH_FEATURE_ 0u
+#endif
+
+#ifdef FIRE_COMPLETE // Programs answer --fire-complete... only if defined before including fire.hpp
+#define FIRE_COMPLETE_FEATURE_ fire::_feature_complete
+#else
+#define FIRE_COMPLETE_FEATURE_ 0u
+#endif
+
+#ifdef FIRE_CONFIG // Programs accept --fire-config=FILE only if defined before including fire.hpp
+#define FIRE_CONFIG_FEATURE_ fire::_feature_config
+#else
+#define FIRE_CONFIG_FEATURE_ 0u
+#endif
+
+#ifdef FIRE_RESPONSE_FILES // Programs expand @FILE only if defined before including fire.hpp
+#define FIRE_RESPONSE_FILES_FEATURE_ fire::_feature_response_files
+#else
+#define FIRE_RESPONSE_FILES_FEATURE_ 0u
+#endif
+
+#define FIRE_FEATURES_ (FIRE_CACHE_FEATURE_ | FIRE_BATCH_FEATURE_ | FIRE_COMPLETE_FEATURE_ | FIRE_CONFIG_FEATURE_ |\
+                        FIRE_RESPONSE_FILES_FEATURE_)
+
+inline fire::_name_table_view fire_declared_names_(long) { return fire::_name_table_view(); } // Overridden by FIRE_NAMES
+
+#define FIRE_ID(...) \
+fire::_checked_declaration(std::integral_constant<bool, fire::_validate_declaration(__VA_ARGS__)>(), __VA_ARGS__)
+
+#define FIRE_NAMES(...) \
+inline fire::_name_table_view fire_declared_names_(int) {\
+    static constexpr auto table = fire::_make_name_table("-h", "--help", __VA_ARGS__);\
+    return table.view();\
 }
 
+#ifdef FIRE_TRACE
+#ifdef __cpp_sized_deallocation
+#define FIRE_TRACE_SIZED_DELETE_ \
+void operator delete(void *p, std::size_t) noexcept { fire::_trace::deallocate(p); }\
+void operator delete[](void *p, std::size_t) noexcept { fire::_trace::deallocate(p); }
+#else
+#define FIRE_TRACE_SIZED_DELETE_
+#endif
+
+#define FIRE_TRACE_ALLOCATOR_ \
+void* operator new(std::size_t size) { return fire::_trace::allocate(size); }\
+void* operator new[](std::size_t size) { return fire::_trace::allocate(size); }\
+void operator delete(void *p) noexcept { fire::_trace::deallocate(p); }\
+void operator delete[](void *p) noexcept { fire::_trace::deallocate(p); }\
+FIRE_TRACE_SIZED_DELETE_
+#else
+#define FIRE_TRACE_ALLOCATOR_
+#endif
+
 #define FIRE(fired_main) \
+FIRE_TRACE_ALLOCATOR_ \
 int main(int argc, const char ** argv) {\
     bool space_assignment = true;\
-    init_and_run(argc, argv, fired_main, space_assignment);\
-    return fired_main();\
+    return fire::_run_main(argc, argv, [&](fire::parser &parser, int fire_argc_, const char **fire_argv_) {\
+        return parser.run(fire_argc_, fire_argv_, fired_main, [] { return fired_main(); }, space_assignment, fire_declared_names_(0));\
+    }, fire_declared_names_(0), fire::_name_table_view(), FIRE_FEATURES_);\
 }
 
 #define FIRE_NO_SPACE_ASSIGNMENT(fired_main) \
+FIRE_TRACE_ALLOCATOR_ \
 int main(int argc, const char ** argv) {\
     bool space_assignment = false;\
-    init_and_run(argc, argv, fired_main, space_assignment);\
-    return fired_main();\
+    return fire::_run_main(argc, argv, [&](fire::parser &parser, int fire_argc_, const char **fire_argv_) {\
+        return parser.run(fire_argc_, fire_argv_, fired_main, [] { return fired_main(); }, space_assignment, fire_declared_names_(0));\
+    }, fire_declared_names_(0), fire::_name_table_view(), FIRE_FEATURES_);\
+}
+
+#define FIRE_EXPAND_(x) x
+#define FIRE_CONCAT_(a, b) FIRE_CONCAT_IMPL_(a, b)
+#define FIRE_CONCAT_IMPL_(a, b) a##b
+#define FIRE_COUNT_IMPL_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45, _46, _47, _48, _49, _50, _51, _52, _53, _54, _55, _56, _57, _58, _59, _60, _61, _62, _63, _64, N, ...) N
+#define FIRE_COUNT_(...) FIRE_EXPAND_(FIRE_COUNT_IMPL_(__VA_ARGS__, 64, 63, 62, 61, 60, 59, 58, 57, 56, 55, 54, 53, 52, 51, 50, 49, 48, 47, 46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36, 35, 34, 33, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0))
+
+// FIRE_FOR_EACH_(m, a, b, ...) expands to m(a), m(b), ... for up to 64 arguments
+#define FIRE_FOR_EACH_(m, ...) FIRE_EXPAND_(FIRE_CONCAT_(FIRE_FOR_EACH_, FIRE_COUNT_(__VA_ARGS__))(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_1(m, x) m(x)
+#define FIRE_FOR_EACH_2(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_1(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_3(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_2(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_4(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_3(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_5(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_4(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_6(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_5(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_7(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_6(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_8(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_7(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_9(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_8(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_10(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_9(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_11(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_10(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_12(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_11(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_13(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_12(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_14(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_13(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_15(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_14(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_16(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_15(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_17(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_16(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_18(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_17(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_19(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_18(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_20(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_19(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_21(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_20(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_22(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_21(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_23(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_22(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_24(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_23(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_25(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_24(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_26(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_25(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_27(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_26(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_28(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_27(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_29(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_28(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_30(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_29(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_31(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_30(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_32(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_31(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_33(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_32(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_34(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_33(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_35(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_34(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_36(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_35(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_37(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_36(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_38(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_37(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_39(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_38(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_40(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_39(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_41(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_40(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_42(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_41(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_43(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_42(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_44(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_43(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_45(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_44(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_46(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_45(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_47(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_46(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_48(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_47(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_49(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_48(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_50(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_49(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_51(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_50(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_52(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_51(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_53(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_52(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_54(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_53(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_55(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_54(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_56(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_55(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_57(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_56(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_58(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_57(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_59(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_58(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_60(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_59(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_61(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_60(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_62(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_61(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_63(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_62(m, __VA_ARGS__))
+#define FIRE_FOR_EACH_64(m, x, ...) m(x), FIRE_EXPAND_(FIRE_FOR_EACH_63(m, __VA_ARGS__))
+
+#define FIRE_SUBCOMMAND_NAME_(subcommand) #subcommand
+#define FIRE_SUBCOMMAND_HANDLER_(subcommand) \
+[](fire::parser &parser, int fire_argc_, const char **fire_argv_, bool space_assignment) {\
+    return parser.run(fire_argc_, fire_argv_, subcommand, [] { return subcommand(); }, space_assignment, fire_declared_names_(0));\
 }
 
+#define FIRE_SUBCOMMANDS_MAIN_(space_assignment, ...) \
+FIRE_TRACE_ALLOCATOR_ \
+int main(int argc, const char ** argv) {\
+    static constexpr auto subcommands = fire::_make_name_table(FIRE_FOR_EACH_(FIRE_SUBCOMMAND_NAME_, __VA_ARGS__));\
+    static const fire::_subcommand_handler handlers[] = {FIRE_FOR_EACH_(FIRE_SUBCOMMAND_HANDLER_, __VA_ARGS__)};\
+    return fire::_run_main(argc, argv, [&](fire::parser &parser, int fire_argc_, const char **fire_argv_) {\
+        return fire::_run_subcommand(parser, fire_argc_, fire_argv_, subcommands.view(), handlers, space_assignment);\
+    }, fire_declared_names_(0), subcommands.view(), FIRE_FEATURES_);\
+}
+
+#define FIRE_SUBCOMMANDS(...) FIRE_SUBCOMMANDS_MAIN_(true, __VA_ARGS__)
+#define FIRE_SUBCOMMANDS_NO_SPACE_ASSIGNMENT(...) FIRE_SUBCOMMANDS_MAIN_(false, __VA_ARGS__)
+
 #endif
@@ -122,6 +122,19 @@ def run_positional(path_prefix):
     runner.equal("-1 -3", "-1 -3")
 
 
+def run_subcommands(path_prefix):
+    runner = assert_runner(path_prefix / "subcommands")
+
+    runner.equal("add -x 3 -y 4", "3 + 4 = 7")
+    runner.equal("square -x 3", "3 * 3 = 9")
+    runner.handled_failure("")
+    runner.handled_failure("subtract")
+    runner.handled_failure("square")
+    runner.handled_failure("add -x 3 -y 4 5")
+    runner.help_success("add -h")
+    runner.help_success("square --help")
+
+
 def run_vector_positional(path_prefix):
     runner = assert_runner(path_prefix / "vector_positional")
 
@@ -149,6 +162,7 @@ def main():
     run_flag(path_prefix)
     run_optional_and_default(path_prefix)
     run_positional(path_prefix)
+    run_subcommands(path_prefix)
     run_vector_positional(path_prefix)
 
     print(" SUCCESS! (ran {} tests with {} checks)".format(assert_runner.test_count, assert_runner.check_count))
@@ -31,7 +31,7 @@ from pathlib import Path
 import os, shutil, subprocess, sys, argparse, json, functools, random
 print = functools.partial(print, flush=True)
 
-description = """Batch-test combinations of compilers and cmake settings. CMake root directory needs to contain a file called `.release_tests.json`. Example contents:
+description = """Batch-test combinations of compilers and cmake settings. CMake root directory needs to contain a file called `.release_tests.json`, the repository's own lists the configurations tested before a release. Example contents:
 {
   "compiler_prefix": "/usr/bin/",
   "compilers": [
@@ -101,14 +101,15 @@ def batch_test(cmake_root, prefix, compilers, cmake_build_types):
                 run(cmd, env=env)
                 run(["cmake", "--build", "."])
                 run([sys.executable, "tests/run_standard_tests.py"])
+                run(["ctest", "--output-on-failure"], cwd="tests") # Also FIRE_TRACE builds, only registered with ctest
 
     print()
     print("++++++++++        SUCCESS        ++++++++++")
     print()
 
 
-def run(cmd, env=None):
-    result = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE, env=env)
+def run(cmd, env=None, cwd=None):
+    result = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE, env=env, cwd=cwd)
     if result.returncode != 0:
         print("STDOUT:")
         print(str(result.stdout, "utf-8"))
@@ -28,6 +28,10 @@
 */
 
 #include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <thread>
 #include "../fire.hpp"
 
 #define EXPECT_EXIT_SUCCESS(statement) EXPECT_EXIT(statement, ::testing::ExitedWithCode(0), "")
@@ -36,15 +40,28 @@
 using namespace std;
 using namespace fire;
 
-void init_args(const vector<string> &args, bool space_assignment, bool strict, int named_calls = 1000000) {
-    const char ** argv = new const char *[args.size()];
-    for(size_t i = 0; i < args.size(); ++i)
-        argv[i] = args[i].c_str();
-
-    fire::_::help_logger = fire::_help_logger();
-    fire::_::matcher = fire::_matcher((int) args.size(), argv, named_calls, space_assignment, strict);
+void set_env(const char *name, const char *value) { // Empty value unsets
+#ifdef _WIN32
+    _putenv_s(name, value);
+#else
+    if(*value)
+        setenv(name, value, 1);
+    else
+        unsetenv(name);
+#endif
+}
 
-    delete [] argv;
+void init_args(const vector<string> &args, bool space_assignment, bool strict, int named_calls = 1000000,
+               const fire::_name_table_view &declared_names = fire::_name_table_view(), unsigned features = 0) {
+    static vector<string> saved_args; // Matcher refers to argv, which must outlive it (as real argv does)
+    saved_args = args;
+    vector<const char *> argv(saved_args.size());
+    for(size_t i = 0; i < saved_args.size(); ++i)
+        argv[i] = saved_args[i].c_str();
+
+    fire::_::help_logger() = fire::_help_logger();
+    fire::_::matcher() = fire::_matcher((int) argv.size(), argv.data(), named_calls, space_assignment, strict,
+                                      declared_names, features);
 }
 
 void init_args(const vector<string> &args) {
@@ -55,6 +72,18 @@ void init_args_strict(const vector<string> &args, int named_calls) {
     init_args(args, true, true, named_calls);
 }
 
+void init_args_cached(const vector<string> &args, int named_calls) { // Program opted in to --fire-cache
+    init_args(args, false, true, named_calls, fire::_name_table_view(), fire::_feature_cache | fire::_feature_response_files);
+}
+
+void init_args_response_files(const vector<string> &args) { // Program opted in to @FILE
+    init_args(args, false, false, 1000000, fire::_name_table_view(), fire::_feature_response_files);
+}
+
+void init_args_config(const vector<string> &args, bool strict = false) { // Program opted in to --fire-config
+    init_args(args, true, strict, strict ? 0 : 1000000, fire::_name_table_view(), fire::_feature_config);
+}
+
 void init_args_no_space(const vector<string> &args) {
     init_args(args, false, false);
 }
@@ -96,6 +125,21 @@ TEST(optional, no_value) {
 }
 
 
+TEST(assert, lazy_message) {
+    int built = 0;
+    auto message = [&] { ++built; return std::string("message"); };
+
+    fire::_instant_assert(true, message);
+    init_args_strict({"./run_tests"}, 1);
+    EXPECT_TRUE(fire::_::matcher().deferred_assert(identifier(), true, message));
+    EXPECT_EQ(built, 0);
+
+    EXPECT_FALSE(fire::_::matcher().deferred_assert(identifier(), false, message));
+    EXPECT_EQ(built, 1);
+    EXPECT_EXIT(fire::_instant_assert(false, message), ::testing::ExitedWithCode(fire::_failure_code), "message");
+}
+
+
 TEST(identifier, prepend_hyphens) {
     EXPECT_EQ(identifier::prepend_hyphens(""), "");
     EXPECT_EQ(identifier::prepend_hyphens("a"), "-a");
@@ -124,6 +168,83 @@ TEST(identifier, constructor) {
     EXPECT_EXIT_FAIL(identifier(vector<string>{"--l"}, empty));
 }
 
+TEST(identifier, compile_time_validation) {
+    static_assert(fire::_validate_declaration("-l", "--long", "description"), "");
+    static_assert(fire::_validate_declaration(0, "<name>"), "");
+    static_assert(fire::_validate_declaration("--long", ""), "");
+
+    EXPECT_THROW(fire::_validate_declaration("-l", "-l"), const char *);
+    EXPECT_THROW(fire::_validate_declaration("--long", "--long"), const char *);
+    EXPECT_THROW(fire::_validate_declaration("-l", 0), const char *);
+    EXPECT_THROW(fire::_validate_declaration("description"), const char *);
+    EXPECT_THROW(fire::_validate_declaration("-long"), const char *);
+    EXPECT_THROW(fire::_validate_declaration("--l"), const char *);
+    EXPECT_THROW(fire::_validate_declaration("-1"), const char *);
+    EXPECT_THROW(fire::_validate_declaration("---long"), const char *);
+    EXPECT_THROW(fire::_validate_declaration("--long", "<name>"), const char *);
+
+    init_args_no_space({"./run_tests", "-l=1", "2"});
+    EXPECT_EQ((int) arg(FIRE_ID("-l", "--long", "description")), 1);
+    EXPECT_EQ((int) arg(FIRE_ID(0, "<name>")), 2);
+    EXPECT_EQ((int) arg(FIRE_ID("--default"), 3), 3);
+}
+
+template <typename F>
+string declaration_error(F validate) {
+    try {
+        validate();
+    } catch(const char *message) {
+        return message;
+    }
+    return "";
+}
+
+// Evaluates FIRE_ID(...) rules and runtime arg({...}) rules on the same entries
+#define EXPECT_DECLARATION_ACCEPTED(...) \
+    EXPECT_EQ(declaration_error([] { fire::_validate_declaration(__VA_ARGS__); }), ""); \
+    EXPECT_EXIT({ (void) arg({__VA_ARGS__}); exit(0); }, ::testing::ExitedWithCode(0), "")
+#define EXPECT_DECLARATION_REJECTED(error, ...) \
+    EXPECT_EQ(declaration_error([] { fire::_validate_declaration(__VA_ARGS__); }), \
+              string(fire::_declaration_message(error))); \
+    EXPECT_EXIT((void) arg({__VA_ARGS__}), ::testing::ExitedWithCode(fire::_failure_code), \
+                fire::_declaration_message(error))
+
+TEST(identifier, declaration_rules) {
+    using fire::_declaration_error;
+
+    EXPECT_DECLARATION_ACCEPTED("-l", "--long", "description");
+    EXPECT_DECLARATION_ACCEPTED(0, "<name>", "description");
+    EXPECT_DECLARATION_ACCEPTED("--long", "", fire::env("FIRE_TEST_RULES"));
+
+    EXPECT_DECLARATION_REJECTED(_declaration_error::hyphens, "---long");
+    EXPECT_DECLARATION_REJECTED(_declaration_error::descr_twice, "-l", "first", "second");
+    EXPECT_DECLARATION_REJECTED(_declaration_error::short_twice, "-a", "-b");
+    EXPECT_DECLARATION_REJECTED(_declaration_error::short_length, "-long");
+    EXPECT_DECLARATION_REJECTED(_declaration_error::short_length, "-");
+    EXPECT_DECLARATION_REJECTED(_declaration_error::short_digit, "-1");
+    EXPECT_DECLARATION_REJECTED(_declaration_error::long_twice, "--aa", "--bb");
+    EXPECT_DECLARATION_REJECTED(_declaration_error::long_length, "--l");
+    EXPECT_DECLARATION_REJECTED(_declaration_error::index_twice, 0, 1);
+    EXPECT_DECLARATION_REJECTED(_declaration_error::env_twice, "--xx", fire::env("A"), fire::env("B"));
+    EXPECT_DECLARATION_REJECTED(_declaration_error::name_and_index, "-l", 0);
+    EXPECT_DECLARATION_REJECTED(_declaration_error::no_name, "description");
+    EXPECT_DECLARATION_REJECTED(_declaration_error::pos_name_without_index, "--long", "<name>");
+}
+
+#define EXPECT_DECLARATION_NAMED(message, ...) \
+    EXPECT_EXIT((void) arg({__VA_ARGS__}), ::testing::ExitedWithCode(fire::_failure_code), message)
+
+TEST(identifier, declaration_messages_name_entries) {
+    EXPECT_DECLARATION_NAMED("Can't specify descriptions twice: first and second", "-l", "first", "second");
+    EXPECT_DECLARATION_NAMED("Can't specify shorthands twice: -a and -b", "-a", "-b");
+    EXPECT_DECLARATION_NAMED("Can't specify long names twice: --aa and --bb", "-a", "--aa", "--bb");
+    EXPECT_DECLARATION_NAMED("Single hyphen shorthand must be one character: -long", "-long");
+    EXPECT_DECLARATION_NAMED("Can't specify index twice: 0 and 1", 0, 1); // Accepted before FIRE_ID(...) existed
+    EXPECT_DECLARATION_NAMED("Can't specify environment variables twice: A and B", "--xx", fire::env("A"), fire::env("B"));
+    EXPECT_DECLARATION_NAMED("Can't specify both name and index: -l and 0", "-l", 0);
+    EXPECT_DECLARATION_NAMED("Positional name requires the argument to be positional: <name>", "--long", "<name>");
+}
+
 TEST(identifier, overlap) {
     fire::optional<int> empty;
 
@@ -276,6 +397,258 @@ TEST(matcher, no_space_assignment) {
 }
 
 
+TEST(matcher, response_file) {
+    const char *path = "fire_response_file_test.txt";
+    std::ofstream(path) << "-x=1\n  \"two words\" 'single \\q'\tesc\\ aped \"quote\\\"d\" tail";
+
+    init_args_response_files({"./run_tests", "0", string("@") + path, "--last"});
+    EXPECT_EQ((int) arg("-x"), 1);
+    EXPECT_TRUE((bool) arg("--last"));
+    vector<string> positional = arg::vector();
+    EXPECT_EQ(positional, vector<string>({"0", "two words", "single \\q", "esc aped", "quote\"d", "tail"}));
+
+    init_args_response_files({"./run_tests", string("@") + path, "--last"});
+    EXPECT_EQ(string(((fire::string_view) arg("-x")).c_str()), "1"); // Views into the file are terminated on query
+    vector<fire::string_view> views = arg::vector();
+    vector<string> terminated;
+    for(const fire::string_view &view: views)
+        terminated.push_back(view.c_str());
+    EXPECT_EQ(terminated, vector<string>({"two words", "single \\q", "esc aped", "quote\"d", "tail"}));
+
+    init_args_response_files({"./run_tests", "@nonexistent_file", "@"});
+    vector<string> literal = arg::vector();
+    EXPECT_EQ(literal, vector<string>({"@nonexistent_file", "@"}));
+
+    std::ofstream(path) << "";
+    init_args_response_files({"./run_tests", string("@") + path});
+    vector<string> empty = arg::vector();
+    EXPECT_EQ(empty, vector<string>());
+
+    std::remove(path);
+}
+
+TEST(matcher, response_file_backslashes) {
+    auto tokenize = [](const string &data, bool backslash_escapes) {
+        fire::_arena copies;
+        fire::_arena_vector<fire::string_view> tokens;
+        fire::_tokenize(data.data(), data.size(), copies, tokens, backslash_escapes);
+        return vector<string>(tokens.begin(), tokens.end());
+    };
+    string data = "C:\\dir\\file \"C:\\quoted dir\" \"say \\\"hi\\\"\" a\\ b";
+    EXPECT_EQ(tokenize(data, true), vector<string>({"C:dirfile", "C:quoted dir", "say \"hi\"", "a b"}));
+    EXPECT_EQ(tokenize(data, false), vector<string>({"C:\\dir\\file", "C:\\quoted dir", "say \"hi\"", "a\\", "b"})); // _WIN32
+}
+
+TEST(matcher, response_file_disabled) {
+    const char *path = "fire_response_disabled_test.txt";
+    std::ofstream(path) << "secret contents";
+
+    init_args_no_space({"./run_tests", string("@") + path});
+    vector<string> literal = arg::vector(); // File isn't read, as the program didn't opt in
+    EXPECT_EQ(literal, vector<string>({string("@") + path}));
+
+    std::remove(path);
+}
+
+TEST(matcher, config_file) {
+    const char *path = "fire_config_file_test.ini";
+    std::ofstream(path) << "# comment\nthreads = 4\r\nname=\"two words\"\n; comment\n\n  verbose = true  \n"
+                           "x = 1\nx = 2\n[db]\nhost = localhost\nport=5432";
+    set_env("FIRE_TEST_CONFIG_THREADS", "8");
+
+    init_args_config({"./run_tests", string("--fire-config=") + path, "--threads", "3"});
+    EXPECT_EQ((int) arg("--threads"), 3); // Command line takes precedence
+    EXPECT_EQ((string) arg("--name"), "two words");
+    EXPECT_TRUE((bool) arg("--verbose"));
+    EXPECT_EQ((int) arg("-x"), 2); // Later definitions take precedence
+    EXPECT_EQ((string) arg("--db.host"), "localhost");
+    EXPECT_EQ(string(((fire::string_view) arg("--db.port")).c_str()), "5432"); // Last value has no room for '\0'
+    EXPECT_EQ((int) arg("--missing", 7), 7);
+    EXPECT_EXIT_FAIL((void) (int) arg("--name"));
+
+    init_args_config({"./run_tests", string("--fire-config=") + path});
+    EXPECT_EQ((int) arg({"--threads", fire::env("FIRE_TEST_CONFIG_THREADS")}), 8); // Environment takes precedence
+
+    EXPECT_EXIT_FAIL(init_args_config({"./run_tests", "--fire-config=nonexistent_file.ini"}, true));
+    std::ofstream(path) << "threads = 4\nno value\n";
+    EXPECT_EXIT_FAIL(init_args_config({"./run_tests", string("--fire-config=") + path}, true));
+
+    std::remove(path);
+}
+
+TEST(matcher, config_file_disabled) {
+    const char *path = "fire_config_disabled_test.ini";
+    std::ofstream(path) << "threads = 4\n";
+
+    init_args_no_space({"./run_tests", string("--fire-config=") + path});
+    EXPECT_EQ((int) arg("--threads", 1), 1); // File isn't read, as the program didn't opt in
+    EXPECT_EQ((string) arg("--fire-config"), path); // An ordinary named argument
+
+    std::remove(path);
+}
+
+TEST(matcher, argument_cache) {
+    const char *response = "fire_cache_test.txt", *cache = "fire_cache_test.cache";
+    std::remove(cache);
+    std::ofstream(response) << "-x=1 -y=2.5 --name=abc 4 5 6";
+    set_env("FIRE_TEST_CACHE_Z", "3");
+    vector<string> argv = {"./run_tests", string("--fire-cache=") + cache, string("@") + response};
+
+    auto convert = [] {
+        int x = arg("-x");
+        double y = arg("-y");
+        string name = arg("--name");
+        fire::string_view view = arg({"--view", fire::env("FIRE_TEST_CACHE_Z")}, "");
+        bool flag = arg("--flag");
+        vector<int> values = arg::vector();
+        return to_string(x) + " " + to_string(y) + " " + name + " " + view.c_str() + " " + to_string(flag) + " " +
+               to_string(values.size() == 3 ? values[0] + values[1] + values[2] : -1);
+    };
+
+    init_args_cached(argv, 6);
+    EXPECT_EQ(convert(), "1 2.500000 abc 3 0 15");
+    EXPECT_TRUE(std::ifstream(cache).good()); // Saved once every argument is converted
+
+    init_args_cached(argv, 6);
+    EXPECT_TRUE(fire::_::matcher().get_positional().empty()); // Hit, argv isn't parsed
+    EXPECT_EQ(convert(), "1 2.500000 abc 3 0 15");
+
+    std::ofstream(response) << "-x=10 -y=2.5 --name=abc --flag 4 5 6";
+    init_args_cached(argv, 6);
+    EXPECT_EQ(fire::_::matcher().get_positional().size(), 3u); // Response file changed
+    EXPECT_EQ(convert(), "10 2.500000 abc 3 1 15");
+
+    set_env("FIRE_TEST_CACHE_Z", "4");
+    init_args_cached(argv, 6);
+    EXPECT_EQ(convert(), "10 2.500000 abc 4 1 15");
+
+    auto convert_float = [] { // -y declared as float
+        int x = arg("-x");
+        float y = arg("-y");
+        string name = arg("--name");
+        string view = arg({"--view", fire::env("FIRE_TEST_CACHE_Z")}, "");
+        bool flag = arg("--flag");
+        vector<int> values = arg::vector();
+        return to_string(x) + " " + to_string(y) + " " + name + " " + view + " " + to_string(flag) + " " + to_string(values.size());
+    };
+    init_args_cached(argv, 6);
+    EXPECT_EQ(convert_float(), "10 2.500000 abc 4 1 3"); // Declaration changed after -x, argv is parsed
+    init_args_cached(argv, 6);
+    EXPECT_TRUE(fire::_::matcher().get_positional().empty());
+    EXPECT_EQ(convert_float(), "10 2.500000 abc 4 1 3");
+
+    init_args_cached(argv, 6);
+    EXPECT_EXIT_FAIL({ (void) (int) arg("-x"); (void) (int) arg("-y"); (void) (string) arg("--name");
+                       (void) (string) arg("--view"); (void) (bool) arg("--flag"); vector<int> v = arg::vector(); });
+
+    std::remove(response);
+    std::remove(cache);
+}
+
+TEST(matcher, argument_cache_defaults) {
+    const char *cache = "fire_cache_defaults.cache";
+    std::remove(cache);
+    vector<string> argv = {"./run_tests", string("--fire-cache=") + cache, "7"};
+    auto convert = [] {
+        string count = arg("--count", "1");
+        double ratio = arg("--ratio", 0.1);
+        int position = arg(0);
+        return count + " " + to_string(ratio) + " " + to_string(position);
+    };
+
+    init_args_cached(argv, 3);
+    EXPECT_EQ(convert(), "1 0.100000 7");
+    init_args_cached(argv, 3);
+    EXPECT_EQ(convert(), "1 0.100000 7");
+    EXPECT_TRUE(fire::_::matcher().get_positional().empty()); // Hit, float defaults hash the same
+
+    init_args_cached(argv, 3);
+    (void) (string) arg("--count", 1);
+    EXPECT_EQ(fire::_::matcher().get_positional().size(), 1u); // Default changed from "1" to 1, argv is parsed
+    std::remove(cache);
+}
+
+TEST(matcher, argument_cache_disabled) {
+    const char *cache = "fire_cache_disabled.cache";
+    std::remove(cache);
+    vector<string> argv = {"./run_tests", string("--fire-cache=") + cache};
+
+    init_args(argv, false, true, 1);
+    EXPECT_EQ(fire::_::matcher().get_positional().size(), 0u);
+    EXPECT_EXIT_FAIL((void) (int) arg("-x", 1)); // Unknown argument, as the program didn't opt in
+    EXPECT_FALSE(std::ifstream(cache).good());
+
+    init_args_no_space({"./run_tests", string("--fire-cache=") + cache});
+    EXPECT_EQ((string) arg("--fire-cache"), cache); // An ordinary named argument
+    EXPECT_FALSE(fire::_::matcher().caching());
+}
+
+TEST(matcher, arena_release) {
+    fire::_arena arena;
+    for(size_t alignment: {1, 2, 8, 16}) {
+        void *p = arena.allocate(3, alignment);
+        EXPECT_EQ((uintptr_t) p % alignment, 0u);
+    }
+    void *large = arena.allocate(1 << 20, 8);
+    EXPECT_NE(large, nullptr);
+    fire::string_view copy = arena.copy("abc");
+    EXPECT_EQ(copy, "abc");
+    EXPECT_EQ(copy.c_str()[3], '\0');
+
+    const char *path = "fire_arena_test.txt";
+    std::ofstream(path) << "from_file";
+    init_args_response_files({"./run_tests", "-x=1", string("@") + path});
+    EXPECT_EQ((int) arg("-x"), 1);
+    EXPECT_FALSE((bool) arg("--absent"));
+    fire::string_view token = arg(0);
+    fire::release();
+    EXPECT_EQ(token, "from_file"); // Response files outlive the released parser
+    EXPECT_TRUE(fire::_::matcher().get_positional().empty());
+    std::remove(path);
+}
+
+TEST(matcher, declared_names) {
+    static constexpr auto table = fire::_make_name_table("-h", "--help", "-x", "--long", "-f", "--flag");
+    static_assert(table.size() == 6, "");
+    fire::_name_table_view names = table.view();
+    EXPECT_EQ(names.find("-x"), 2u);
+    EXPECT_EQ(names.find("--long"), 3u);
+    EXPECT_EQ(names.find("--flag"), 5u);
+    EXPECT_EQ(names.find("--other"), fire::_name_table_view::npos);
+    EXPECT_EQ(fire::_name_table_view().find("-x"), fire::_name_table_view::npos);
+
+    init_args({"./run_tests", "-x=1", "--long", "abc", "-f"}, true, false, 1000000, names);
+    EXPECT_EQ((int) arg("-x"), 1);
+    EXPECT_EQ((string) arg("--long"), "abc");
+    EXPECT_TRUE((bool) arg({"-f", "--flag"}));
+    EXPECT_EXIT_FAIL((void) (bool) arg("--other")); // Not declared
+
+    init_args({"./run_tests", "-x", "1", "--undeclared"}, true, true, 1, names);
+    EXPECT_EXIT_FAIL((void) (int) arg("-x"));
+    init_args({"./run_tests", "--help"}, true, true, 1, names);
+    EXPECT_EXIT_SUCCESS((void) (int) arg("-x"));
+}
+
+
+#define NAMES_2(prefix) prefix "a", prefix "b"
+#define NAMES_8(prefix) NAMES_2(prefix "c"), NAMES_2(prefix "d"), NAMES_2(prefix "e"), NAMES_2(prefix "f")
+#define NAMES_64(prefix) NAMES_8(prefix "g"), NAMES_8(prefix "h"), NAMES_8(prefix "i"), NAMES_8(prefix "j"), \
+                         NAMES_8(prefix "k"), NAMES_8(prefix "l"), NAMES_8(prefix "m"), NAMES_8(prefix "n")
+#define NAMES_512(prefix) NAMES_64(prefix "o"), NAMES_64(prefix "p"), NAMES_64(prefix "q"), NAMES_64(prefix "r"), \
+                          NAMES_64(prefix "s"), NAMES_64(prefix "t"), NAMES_64(prefix "u"), NAMES_64(prefix "v")
+
+TEST(matcher, many_declared_names) {
+    static constexpr auto table = fire::_make_name_table(NAMES_512("--"));
+    static_assert(table.size() == 512, "");
+    fire::_name_table_view names = table.view();
+    for(size_t i = 0; i < names.count; ++i)
+        EXPECT_EQ(names.find(names.names[i]), i);
+    EXPECT_EQ(names.find("--ogca"), 0u);
+    EXPECT_EQ(names.find("--vnfb"), 511u);
+    EXPECT_EQ(names.find("--other"), fire::_name_table_view::npos);
+    EXPECT_EQ(names.find("--ogc"), fire::_name_table_view::npos);
+}
+
 TEST(help, help_invocation) {
     EXPECT_EXIT_SUCCESS(init_args_strict({"./run_tests", "-h"}, 0));
     EXPECT_EXIT_SUCCESS(init_args_strict({"./run_tests", "--help"}, 0));
@@ -314,6 +687,18 @@ TEST(help, no_space_assignment_help_invocation) {
     EXPECT_EXIT_SUCCESS(vector<string> v_undef = arg::vector());
 }
 
+TEST(help, gathered_only_on_request) {
+    init_args({"./run_tests", "-i", "1"});
+    (void) (int) arg({"-i", "--integer"}, 0);
+    testing::internal::CaptureStderr();
+    fire::_::help_logger().print_help();
+    EXPECT_EQ(testing::internal::GetCapturedStderr().find("--integer"), string::npos);
+
+    init_args_strict({"./run_tests", "-h"}, 2);
+    (void) (int) arg({"-i", "--integer"}, 0);
+    EXPECT_EXIT((void) (double) arg("--real", 1.5), ::testing::ExitedWithCode(0), "--integer=INTEGER");
+}
+
 
 TEST(arg, argument_naming) {
     init_args({"./run_tests"});
@@ -415,6 +800,166 @@ TEST(arg, all_positional_parsing) {
     EXPECT_EQ(all2, vector<std::string>({"text"}));
 }
 
+TEST(arg, all_positional_conversion) {
+    init_args_no_space({"./run_tests", "-1", "2.5", "1e3"});
+    vector<double> reals = arg::vector();
+    EXPECT_EQ(reals, vector<double>({-1, 2.5, 1e3}));
+
+    init_args_no_space({"./run_tests", "0", "255"});
+    vector<uint8_t> bytes = arg::vector();
+    EXPECT_EQ(bytes, vector<uint8_t>({0, 255}));
+
+    init_args_no_space({"./run_tests", "0", "256"});
+    EXPECT_EXIT_FAIL(vector<uint8_t> v = arg::vector());
+
+    init_args_no_space({"./run_tests", "0", "1.5"});
+    EXPECT_EXIT_FAIL(vector<int> v = arg::vector());
+
+    init_args_no_space({"./run_tests", "0", "x"});
+    EXPECT_EXIT_FAIL(vector<double> v = arg::vector());
+}
+
+string many_words() {
+    string words;
+    for(int i = 0; i < 50000; ++i)
+        words += "word" + to_string(i) + " ";
+    return words;
+}
+
+TEST(arg, stream) {
+    vector<string> args = {"./run_tests"};
+    for(int i = 0; i < 5000; ++i)
+        args.push_back(to_string(i));
+    init_args_no_space(args);
+    fire::stream<int> ints = arg::vector();
+    long long sum = 0, count = 0;
+    for(int x: ints)
+        sum += x, ++count;
+    EXPECT_EQ(count, 5000);
+    EXPECT_EQ(sum, 4999LL * 5000 / 2);
+
+    init_args_no_space(args);
+    {
+        fire::stream<string> partial = arg::vector(); // Stops producer when destroyed early
+        string first;
+        EXPECT_TRUE(partial.next(first));
+        EXPECT_EQ(first, "0");
+    }
+
+    init_args_no_space(args);
+    {
+        fire::stream<long> released = arg::vector();
+        fire::release(); // Stream keeps the positional arguments it reads
+        vector<vector<char>> scribble; // Reuses memory freed by a release that didn't keep the arguments
+        for(size_t size = 16; size <= (1 << 20); size *= 2)
+            scribble.emplace_back(size, '\xff');
+        long long released_sum = 0;
+        for(long x: released)
+            released_sum += x;
+        EXPECT_EQ(released_sum, 4999LL * 5000 / 2);
+    }
+
+    const char *path = "fire_stream_response.txt";
+    std::ofstream(path) << many_words(); // More than the stream converts ahead
+    init_args_response_files({"./run_tests", string("@") + path});
+    {
+        fire::stream<string> from_file = arg::vector();
+        init_args_no_space({"./run_tests"}); // Replaces the matcher, stream keeps the response file it reads
+        size_t words = 0;
+        for(const string &word: from_file)
+            words += word == "word" + to_string(words);
+        EXPECT_EQ(words, 50000u);
+    }
+    std::remove(path);
+
+    init_args_no_space({"./run_tests"});
+    fire::stream<double> empty = arg::vector();
+    EXPECT_TRUE(empty.begin() == empty.end());
+
+    init_args_no_space({"./run_tests", "-"});
+    istringstream input("1.5 -2\n\t3e2\n");
+    streambuf *cin_buffer = cin.rdbuf(input.rdbuf());
+    {
+        fire::stream<double> reals = arg::vector();
+        vector<double> values(reals.begin(), reals.end());
+        EXPECT_EQ(values, vector<double>({1.5, -2, 300}));
+    }
+
+    string many;
+    for(int i = 0; i < 100000; ++i)
+        many += to_string(i) + " ";
+    istringstream many_input(many);
+    cin.rdbuf(many_input.rdbuf());
+    init_args_no_space({"./run_tests", "-"});
+    {
+        fire::stream<int> partial = arg::vector(); // Standard input is read only as far as the consumer gets
+        int first = -1;
+        EXPECT_TRUE(partial.next(first));
+        EXPECT_EQ(first, 0);
+    }
+    int rest = -1;
+    EXPECT_TRUE(cin >> rest);
+    EXPECT_EQ(rest, 1);
+
+    istringstream bad_input("1 x 3");
+    cin.rdbuf(bad_input.rdbuf());
+    init_args_no_space({"./run_tests", "-"});
+    EXPECT_EXIT_FAIL({
+        fire::stream<int> bad = arg::vector();
+        for(int x: bad)
+            (void) x;
+    });
+    cin.rdbuf(cin_buffer);
+
+    EXPECT_EXIT({ // Destroying a stream on standard input that nothing arrives to doesn't block
+        struct : streambuf {
+            int underflow() override { std::this_thread::sleep_for(std::chrono::hours(1)); return traits_type::eof(); }
+        } silent_input;
+        cin.rdbuf(&silent_input);
+        init_args_no_space({"./run_tests", "-"});
+        {
+            fire::stream<int> waiting = arg::vector();
+        }
+        exit(0);
+    }, ::testing::ExitedWithCode(0), "");
+
+    init_args_no_space({"./run_tests", "1", "2", "x"});
+    EXPECT_EXIT_FAIL({
+        fire::stream<int> bad = arg::vector();
+        for(int x: bad)
+            (void) x;
+    });
+}
+
+TEST(arg, string_view) {
+    init_args_no_space({"./run_tests", "-s=abc", "--long", "xyz", "-ab"});
+
+    fire::string_view s = arg("-s");
+    EXPECT_EQ(s, "abc");
+    EXPECT_STREQ(s.c_str(), "abc");
+    fire::string_view def = arg("-d", "default");
+    EXPECT_EQ(def, "default");
+    fire::optional<fire::string_view> undef = arg("--undefined");
+    EXPECT_FALSE(undef.has_value());
+    EXPECT_TRUE((bool) arg("--long"));
+    EXPECT_TRUE((bool) arg("-a"));
+    EXPECT_TRUE((bool) arg("-b"));
+
+    init_args_no_space({"./run_tests", "xyz"});
+    fire::string_view pos = arg(0);
+    EXPECT_EQ(pos, "xyz");
+
+    init_args_no_space({"./run_tests", "a", "bc"});
+    vector<fire::string_view> views = arg::vector();
+    EXPECT_EQ(views, vector<fire::string_view>({"a", "bc"}));
+
+    init_args_no_space({"./run_tests", "a", "bc"});
+    vector<const char *> c_strings = arg::vector();
+    ASSERT_EQ(c_strings.size(), 2u);
+    EXPECT_STREQ(c_strings[0], "a");
+    EXPECT_STREQ(c_strings[1], "bc");
+}
+
 TEST(arg, precision) {
     init_args({"./run_tests", "--65535", "65535", "--65536", "65536",
                "--permitted", "1000000000000", "--overflow", "100000000000000000000000000000000000000"});
@@ -438,6 +983,58 @@ TEST(arg, precision) {
     EXPECT_EXIT_FAIL((void) (float) arg("-a", 1e100));
 }
 
+TEST(arg, integer_widths) {
+    init_args({"./run_tests", "--i8-min", "-128", "--i8-under", "-129", "--u8-max", "255", "--u8-over", "256",
+               "--u64-max", "18446744073709551615", "--u64-over", "18446744073709551616",
+               "--i64-min", "-9223372036854775808", "--i64-under", "-9223372036854775809",
+               "--negative-zero", "-0", "--plus", "+7", "--sign", "-", "--trailing", "12x"});
+
+    EXPECT_EQ((int8_t) arg("--i8-min"), -128);
+    EXPECT_EXIT_FAIL((void) (int8_t) arg("--i8-under"));
+    EXPECT_EQ((uint8_t) arg("--u8-max"), 255);
+    EXPECT_EXIT_FAIL((void) (uint8_t) arg("--u8-over"));
+    EXPECT_EQ((uint64_t) arg("--u64-max"), std::numeric_limits<uint64_t>::max());
+    EXPECT_EXIT_FAIL((void) (uint64_t) arg("--u64-over"));
+    EXPECT_EQ((int64_t) arg("--i64-min"), std::numeric_limits<int64_t>::lowest());
+    EXPECT_EXIT_FAIL((void) (int64_t) arg("--i64-under"));
+    EXPECT_EQ((unsigned) arg("--negative-zero"), 0u);
+    EXPECT_EQ((int) arg("--plus"), 7);
+    EXPECT_EXIT_FAIL((void) (int) arg("--sign"));
+    EXPECT_EXIT_FAIL((void) (int) arg("--trailing"));
+}
+
+TEST(arg, real_numbers) {
+    string above_halfway = "9007199254740993." + string(900, '0') + "1"; // Beyond digits kept exactly
+    init_args({"./run_tests", "--halfway", "9007199254740993", "--e23", "1e23", "--tenth", "0.1",
+               "--denormal", "4.9406564584124654e-324", "--max", "1.7976931348623157e308", "--overflow", "1.8e308",
+               "--float-overflow", "3.5e38", "--long", above_halfway, "--no-digits", ".e3", "--hex", "0x10", "--point", "5."});
+
+    EXPECT_EQ((double) arg("--halfway"), 9007199254740992.0);
+    EXPECT_EQ((double) arg("--e23"), 1e23);
+    EXPECT_EQ((float) arg("--tenth"), 0.1f);
+    EXPECT_EQ((double) arg("--denormal"), std::numeric_limits<double>::denorm_min());
+    EXPECT_EQ((double) arg("--max"), std::numeric_limits<double>::max());
+    EXPECT_EXIT_FAIL((void) (double) arg("--overflow"));
+    EXPECT_EXIT_FAIL((void) (float) arg("--float-overflow"));
+    EXPECT_EQ((double) arg("--long"), 9007199254740994.0);
+    EXPECT_EXIT_FAIL((void) (double) arg("--no-digits"));
+    EXPECT_EXIT_FAIL((void) (double) arg("--hex"));
+    EXPECT_EQ((double) arg("--point"), 5.0);
+}
+
+TEST(arg, real_number_grammar) { // Accepted by std::stold before real numbers were parsed directly
+    for(const char *rejected: {"0x10", "0x1p4", "inf", "-inf", "infinity", "nan", "NAN", "nan(1)",
+                               "1.5abc", "1.5 ", "2e", "1e5x", "."}) {
+        double value = 0;
+        EXPECT_EQ(fire::_parse_value(fire::string_view(rejected), value), fire::_conversion::invalid) << rejected;
+    }
+
+    init_args({"./run_tests", "--nan", "nan", "--suffix", "2.5x", "--spaces", " \t-2.5"});
+    EXPECT_EXIT((void) (double) arg("--nan"), ::testing::ExitedWithCode(fire::_failure_code), "value nan is not a real number");
+    EXPECT_EXIT_FAIL((void) (double) arg("--suffix"));
+    EXPECT_EQ((double) arg("--spaces"), -2.5); // Leading whitespace is still skipped
+}
+
 TEST(arg, dashed_values) {
     init_args({"./run_tests", "-x", "-1", "-y=-1", "-z=-name", "-w=--name", "-q=---name"});
 
@@ -493,6 +1090,16 @@ TEST(arg, strict_query_all_positional) {
     EXPECT_EXIT_FAIL(vector<int> all2 = arg::vector());
 }
 
+TEST(arg, strict_query_aliases) {
+    init_args_strict({"./run_tests", "--long", "1"}, 2);
+    EXPECT_EQ((int) arg({"-l", "--long"}), 1);
+    EXPECT_EXIT_FAIL((void) (int) arg("--long"));
+
+    init_args_strict({"./run_tests", "-l", "1"}, 2);
+    EXPECT_EQ((int) arg({"-l", "--long"}), 1);
+    EXPECT_EXIT_FAIL((void) (int) arg("-l"));
+}
+
 TEST(arg, optional_arguments) {
     init_args({"./run_tests", "-i", "1", "-f", "1.0", "-s", "test"});
 
@@ -538,3 +1145,296 @@ TEST(arg, negative) {
     EXPECT_EQ((int) arg(0), -10);
     EXPECT_EQ((int) arg("-a"), -20);
 }
+
+int parsed_sum(int x = arg("-x"), int y = arg("-y")) {
+    return x + y;
+}
+
+TEST(arg, environment) {
+    set_env("FIRE_TEST_THREADS", "8");
+    set_env("FIRE_TEST_BAD", "eight");
+    set_env("FIRE_TEST_BIG", "300");
+    set_env("FIRE_TEST_FLAG", "1");
+    set_env("FIRE_TEST_UNSET", "");
+    init_args({"./run_tests", "--given", "3"}); // Environment is indexed here, later changes aren't seen
+    set_env("FIRE_TEST_LATE", "1");
+
+    EXPECT_EQ((int) arg({"--threads", fire::env("FIRE_TEST_THREADS")}), 8);
+    EXPECT_EQ((int) arg({"--given", fire::env("FIRE_TEST_THREADS")}), 3);
+    EXPECT_EQ((int) arg({"--unset", fire::env("FIRE_TEST_UNSET")}, 5), 5);
+    EXPECT_EQ((string) arg({"-s", fire::env("FIRE_TEST_BAD")}), "eight");
+    EXPECT_EQ((int) arg(FIRE_ID("--checked", fire::env("FIRE_TEST_THREADS"))), 8);
+    EXPECT_TRUE((bool) arg({"--flag", fire::env("FIRE_TEST_FLAG")}));
+    fire::optional<int> late = arg({"--late", fire::env("FIRE_TEST_LATE")});
+    EXPECT_FALSE(late.has_value());
+
+    EXPECT_EXIT_FAIL((void) (int) arg({"--bad", fire::env("FIRE_TEST_BAD")}));
+    EXPECT_EXIT_FAIL((void) (int8_t) arg({"--big", fire::env("FIRE_TEST_BIG")}));
+    EXPECT_EXIT_FAIL((void) (bool) arg({"--bad-flag", fire::env("FIRE_TEST_BAD")}));
+    EXPECT_EXIT_FAIL((void) (int) arg({"--twice", fire::env("FIRE_TEST_BAD"), fire::env("FIRE_TEST_BIG")}));
+}
+
+TEST(parser, concurrent_instances) {
+    const int thread_count = 8, repeats = 50;
+    vector<int> results(thread_count);
+    vector<thread> threads;
+    for(int t = 0; t < thread_count; ++t)
+        threads.emplace_back([&results, t] {
+            string x = "-x=" + to_string(t), y = "-y=" + to_string(100 * t);
+            const char *argv[] = {"./run_tests", x.c_str(), y.c_str(), nullptr};
+            fire::parser parser; // Reused for every run
+            for(int i = 0; i < repeats; ++i)
+                results[t] += parser.run(3, argv, parsed_sum, [] { return parsed_sum(); });
+        });
+    for(thread &th: threads)
+        th.join();
+
+    for(int t = 0; t < thread_count; ++t)
+        EXPECT_EQ(results[t], repeats * 101 * t);
+    EXPECT_EQ(fire::_::active, nullptr);
+}
+
+TEST(parser, leaves_global_state_alone) {
+    init_args({"./run_tests", "-x", "5"});
+    const char *argv[] = {"./run_tests", "-x=1", "-y=2", nullptr};
+    fire::parser parser;
+    EXPECT_EQ(parser.run(3, argv, parsed_sum, [] { return parsed_sum(); }), 3);
+    EXPECT_EQ((int) arg("-x"), 5);
+
+    const char *bad_argv[] = {"./run_tests", "-x=1", nullptr};
+    EXPECT_EXIT_FAIL(parser.run(2, bad_argv, parsed_sum, [] { return parsed_sum(); }));
+}
+
+TEST(parser, throw_exception_mode) {
+    fire::parser parser(fire::on_error::throw_exception);
+    auto call = [] { return parsed_sum(); };
+
+    const char *missing[] = {"./run_tests", "-x=1", nullptr};
+    try {
+        parser.run(2, missing, parsed_sum, call);
+        FAIL() << "expected fire::error";
+    } catch(const fire::error &e) {
+        EXPECT_EQ(e.code(), fire::_failure_code);
+        EXPECT_EQ(string(e.what()), "Error: required argument -y not provided\n");
+    }
+
+    const char *invalid[] = {"./run_tests", "-x=1", "-y=a", nullptr};
+    EXPECT_THROW(parser.run(3, invalid, parsed_sum, call), fire::error);
+
+    const char *help[] = {"./run_tests", "--help", nullptr};
+    try {
+        parser.run(2, help, parsed_sum, call);
+        FAIL() << "expected fire::error";
+    } catch(const fire::error &e) {
+        EXPECT_EQ(e.code(), 0);
+        EXPECT_NE(string(e.what()).find("Usage:\n      ./run_tests -x=INTEGER -y=INTEGER"), string::npos);
+    }
+
+    const char *valid[] = {"./run_tests", "-x=1", "-y=2", nullptr};
+    EXPECT_EQ(parser.run(3, valid, parsed_sum, call), 3);
+    EXPECT_EQ(fire::_::active, nullptr);
+}
+
+int parsed_negative(int x = arg("-x")) {
+    return -x;
+}
+
+TEST(subcommands, dispatch) {
+    static constexpr auto subcommands = fire::_make_name_table("sum", "negative");
+    const fire::_subcommand_handler handlers[] = {
+        FIRE_FOR_EACH_(FIRE_SUBCOMMAND_HANDLER_, parsed_sum, parsed_negative)
+    };
+    auto run = [&](vector<const char *> argv) {
+        argv.push_back(nullptr);
+        fire::parser parser;
+        return fire::_run_subcommand(parser, (int) argv.size() - 1, argv.data(), subcommands.view(), handlers, true);
+    };
+
+    EXPECT_EQ(run({"./run_tests", "sum", "-x", "1", "-y", "2"}), 3);
+    EXPECT_EQ(run({"./run_tests", "negative", "-x", "4"}), -4);
+    EXPECT_EXIT_FAIL(run({"./run_tests", "negative", "-x", "4", "-y", "2"})); // -y only belongs to sum
+    EXPECT_EXIT_FAIL(run({"./run_tests", "product"}));
+    EXPECT_EXIT_FAIL(run({"./run_tests"}));
+    EXPECT_EXIT_SUCCESS(run({"./run_tests", "--help"}));
+    EXPECT_EXIT_SUCCESS(run({"./run_tests", "sum", "--help"}));
+}
+
+int parsed_length(string batch = arg("--fire-batch")) {
+    return (int) batch.size();
+}
+
+TEST(batch, runs_each_line) {
+    const char *path = "fire_batch_test.txt";
+    std::ofstream(path) << "-x=1 -y=2\n-x=1\n-x='5' -y=6\n\n  # -x=7\n \t\n-x=3 -y=4 --help\n-y=1\n";
+    string flag = string("--fire-batch=") + path;
+    const char *argv[] = {"./run_tests", flag.c_str(), nullptr};
+
+    vector<int> sums;
+    auto run_with = [&](fire::parser &parser, int argc, const char **argv) {
+        sums.push_back(parser.run(argc, argv, parsed_sum, [] { return parsed_sum(); }));
+        return 0;
+    };
+
+    testing::internal::CaptureStderr();
+    fire::_name_table_view none = fire::_name_table_view();
+    EXPECT_EQ(fire::_run_main(2, argv, run_with, none, none, fire::_feature_batch), fire::_failure_code);
+    string errors = testing::internal::GetCapturedStderr();
+    std::remove(path);
+
+    EXPECT_EQ(sums, vector<int>({3, 11})); // Blank and comment lines aren't run
+    EXPECT_NE(errors.find("Error: required argument -y not provided\n"), string::npos);
+    EXPECT_NE(errors.find("Usage:"), string::npos);
+    EXPECT_NE(errors.find("Batch line 2: exit code 1\n"), string::npos);
+    EXPECT_NE(errors.find("Batch line 8: exit code 1\n"), string::npos);
+    EXPECT_EQ(errors.find("Batch line 7"), string::npos); // Help succeeds
+    EXPECT_EQ(errors.find("required argument -x"), errors.rfind("required argument -x"));
+
+    const char *missing[] = {"./run_tests", "--fire-batch=missing_batch_file.txt", nullptr};
+    EXPECT_EXIT_FAIL(fire::_run_main(2, missing, run_with, none, none, fire::_feature_batch));
+}
+
+TEST(batch, requires_opt_in) {
+    const char *argv[] = {"./run_tests", "--fire-batch=batch.txt", nullptr};
+    auto run_with = [](fire::parser &parser, int argc, const char **argv) {
+        return parser.run(argc, argv, parsed_length, [] { return parsed_length(); });
+    };
+    EXPECT_EQ(fire::_run_main(2, argv, run_with), 9); // An ordinary argument, as the program didn't opt in
+}
+
+TEST(completion, candidates) {
+    static constexpr auto options = fire::_make_name_table("-h", "--help", "-x", "--xx", "--verbose");
+    static constexpr auto subcommands = fire::_make_name_table("sum", "negative");
+    int runs = 0;
+    auto run_with = [&](fire::parser &parser, int argc, const char **argv) {
+        ++runs;
+        return parser.run(argc, argv, parsed_sum, [] { return parsed_sum(); });
+    };
+    auto complete = [&](vector<const char *> words, const fire::_name_table_view &names,
+                        const fire::_name_table_view &commands) {
+        words.insert(words.begin(), {"./run_tests", "--fire-complete"});
+        words.push_back(nullptr);
+        return fire::_complete((int) words.size() - 1, words.data(), names, commands, run_with);
+    };
+    fire::_name_table_view none = fire::_name_table_view();
+
+    EXPECT_EQ(complete({"1", "./run_tests", "--"}, options.view(), none), "--help\n--xx\n--verbose\n");
+    EXPECT_EQ(complete({"2", "./run_tests", "--xx=1", "-"}, options.view(), none), "-h\n--help\n-x\n--verbose\n");
+    EXPECT_EQ(complete({"2", "./run_tests", "--xx", ""}, options.view(), none), ""); // Value position
+    EXPECT_EQ(complete({"1", "./run_tests"}, none, subcommands.view()), "sum\nnegative\n");
+    EXPECT_EQ(complete({"1", "./run_tests", "ne"}, none, subcommands.view()), "negative\n");
+    EXPECT_EQ(runs, 0);
+
+    EXPECT_EQ(complete({"2", "./run_tests", "-x=1", "-"}, none, none), "-y\n"); // Names read from help
+    EXPECT_EQ(runs, 1);
+    EXPECT_EQ(fire::_help_option_names("\n    Options:\n      [-t|--threads=INTEGER]  n\n      [<0> INTEGER]\n      -o=TEXT\n"),
+              vector<string>({"-t", "--threads", "-o"}));
+
+    EXPECT_EXIT_FAIL(complete({"x", "./run_tests"}, options.view(), none));
+    EXPECT_EXIT_FAIL(complete({"3", "./run_tests"}, options.view(), none));
+    EXPECT_NE(fire::_completion_script("bash", "/usr/bin/my-tool").find("complete -o default -F _fire_complete_my_tool my-tool\n"),
+              string::npos);
+    EXPECT_EQ(fire::_completion_script("zsh", "my-tool").find("#compdef my-tool\n"), 0u);
+    EXPECT_EXIT_FAIL(fire::_completion_script("fish", "my-tool"));
+}
+
+int parsed_script_length(string script = arg("--fire-complete-script")) {
+    return (int) script.size();
+}
+
+TEST(completion, requires_opt_in) {
+    const char *argv[] = {"./run_tests", "--fire-complete-script=bash", nullptr};
+    auto run_with = [](fire::parser &parser, int argc, const char **argv) {
+        return parser.run(argc, argv, parsed_script_length, [] { return parsed_script_length(); });
+    };
+    fire::_name_table_view none = fire::_name_table_view();
+    EXPECT_EQ(fire::_run_main(2, argv, run_with), 4); // An ordinary argument, as the program didn't opt in
+
+    testing::internal::CaptureStdout();
+    EXPECT_EQ(fire::_run_main(2, argv, run_with, none, none, fire::_feature_complete), 0);
+    EXPECT_NE(testing::internal::GetCapturedStdout().find("complete -o default"), string::npos);
+}
+
+TEST(arg, parallel_vector) {
+    vector<string> args = {"./run_tests"};
+    for(int i = 0; i < 50000; ++i)
+        args.push_back(to_string(i * 7 - 1000));
+
+    init_args(args, false, false);
+    vector<int> serial = arg::vector();
+    init_args(args, false, false);
+    vector<int> parallel = arg::vector().parallel(4);
+    EXPECT_EQ(parallel, serial);
+
+    args[45001] = "x";
+    args[20001] = "99999999999";
+    args[30001] = "1.5";
+    fire::_::global.mode = fire::on_error::throw_exception;
+    auto first_error = [&](unsigned threads) {
+        init_args(args, false, true, 1);
+        try {
+            vector<int> values = arg::vector().parallel(threads);
+        } catch(const fire::error &e) {
+            return string(e.what());
+        }
+        return string();
+    };
+    string expected = first_error(1);
+    EXPECT_NE(expected.find("99999999999"), string::npos);
+    EXPECT_EQ(first_error(3), expected);
+    EXPECT_EQ(first_error(8), expected);
+    EXPECT_EQ(first_error(0), expected);
+    fire::_::global.mode = fire::on_error::exit;
+}
+
+template <typename T>
+void expect_bulk_matches_scalar(const vector<string> &tokens) {
+    vector<fire::string_view> values(tokens.begin(), tokens.end());
+    vector<T> bulk(values.size());
+    for(size_t begin = 0; begin < values.size();) {
+        fire::_conversion result = fire::_conversion::ok;
+        size_t failed = begin + fire::_parse_range(values.data() + begin, values.size() - begin, bulk.data() + begin, result);
+        for(size_t i = begin; i < values.size() && i <= failed; ++i) {
+            T scalar = T();
+            fire::_conversion scalar_result = fire::_parse_value(values[i], scalar);
+            if(i < failed) {
+                EXPECT_EQ(scalar_result, fire::_conversion::ok) << tokens[i];
+                EXPECT_TRUE(scalar == bulk[i] && signbit((double) scalar) == signbit((double) bulk[i])) << tokens[i];
+            } else {
+                EXPECT_EQ(scalar_result, result) << tokens[i];
+            }
+        }
+        begin = failed + 1;
+    }
+}
+
+TEST(conversion, bulk_matches_scalar) {
+    mt19937 random(12345);
+    const string alphabet = "0123456789";
+    vector<string> tokens = {"0", "-0", "+0", "-0.0", "9999999999999999", "-9999999999999999", "4294967295", "4294967296",
+                             "-2147483648", "-2147483649", "127", "128", "-128", "255", "256", "1.", ".5", ".", "-", "+",
+                             "1.2.3", "1e5", " 1", "1 ", "12a", "0.1", "0.30000000000000004", "9007199254740993",
+                             "16777217", "3.4028235e38", "0000000000000001", "123456789.1234567", "1e", "1e+", "1e-",
+                             "e5", ".e1", "1.e1", "1E-0", "1e22", "1e23", "1e-22", "1e-23", "1e1234", "1e+-1", "5e-324"};
+    for(int i = 0; i < 20000; ++i) {
+        string token = random() % 3 == 0 ? "-" : random() % 4 == 0 ? "+" : "";
+        size_t length = 1 + random() % 19;
+        for(size_t j = 0; j < length; ++j)
+            token += alphabet[random() % alphabet.size()];
+        if(random() % 2)
+            token.insert(token.size() - random() % token.size(), 1, '.');
+        if(random() % 3 == 0)
+            token += string(random() % 2 ? "e" : "E") + (random() % 2 ? "-" : "") + to_string(random() % 40);
+        if(random() % 50 == 0)
+            token[random() % token.size()] = "xe. "[random() % 4];
+        tokens.push_back(token);
+    }
+
+    expect_bulk_matches_scalar<int>(tokens);
+    expect_bulk_matches_scalar<long long>(tokens);
+    expect_bulk_matches_scalar<unsigned>(tokens);
+    expect_bulk_matches_scalar<int8_t>(tokens);
+    expect_bulk_matches_scalar<uint64_t>(tokens);
+    expect_bulk_matches_scalar<float>(tokens);
+    expect_bulk_matches_scalar<double>(tokens);
+    expect_bulk_matches_scalar<long double>(tokens);
+}